@@ -1,6 +1,7 @@
 package cmd
 
 import (
+	"encoding/binary"
 	"fmt"
 	"log"
 	"strings"
@@ -78,15 +79,62 @@ func (c *Cmd) run(cmd *cobra.Command, _ []string) error {
 	return conductor.Subscribe(cmd.Context(), handler, idlestrategy.Busy{})
 }
 
+// Framing written by the C publishers, see src/bench_message.h.
+const (
+	frameHeaderLength   = 12 // sequence u64, source_id u16, count u16
+	frameSourceIDOffset = 8
+	frameCountOffset    = 10
+	warmUpSourceFlag    = 0x8000
+	typedQuoteLength    = 1 + 39
+	typedTradeLength    = 1 + 30
+)
+
 func handler(buffer *atomic.Buffer, offset int32, length int32, _ *logbuffer.Header) {
-	var err error
 	bytes := buffer.GetBytesArray(offset, length)
+	if len(bytes) < frameHeaderLength {
+		log.Printf("short frame: %d bytes\n", len(bytes))
+		return
+	}
+
+	// warm-up frames and the warm-up end marker, a frame of count 0, carry nothing to print
+	sourceID := binary.LittleEndian.Uint16(bytes[frameSourceIDOffset:])
+	count := int(binary.LittleEndian.Uint16(bytes[frameCountOffset:]))
+	if sourceID&warmUpSourceFlag != 0 || count == 0 {
+		return
+	}
 
+	message := bytes[frameHeaderLength:]
+	for i := 0; i < count; i++ {
+		if len(message) == 0 {
+			log.Printf("frame truncated after %d of %d messages\n", i, count)
+			return
+		}
+
+		var messageLength int
+		switch message[0] {
+		case opra.MsgTypeQuote:
+			messageLength = typedQuoteLength
+		case opra.MsgTypeTrade:
+			messageLength = typedTradeLength
+		default:
+			log.Printf("invalid message type: %c\n", message[0])
+			return
+		}
+		if len(message) < messageLength {
+			log.Printf("frame truncated after %d of %d messages\n", i, count)
+			return
+		}
+
+		printMessage(message[:messageLength])
+		message = message[messageLength:]
+	}
+}
+
+func printMessage(bytes []byte) {
 	switch bytes[0] {
 	case opra.MsgTypeQuote:
 		q := &opra.Quote{}
-		err = q.UnmarshalUnsafe(bytes)
-		if err != nil {
+		if err := q.UnmarshalUnsafe(bytes); err != nil {
 			log.Panicf("invalid quote: %s", err)
 			return
 		}
@@ -94,14 +142,10 @@ func handler(buffer *atomic.Buffer, offset int32, length int32, _ *logbuffer.Hea
 
 	case opra.MsgTypeTrade:
 		t := &opra.Trade{}
-		err = t.UnmarshalUnsafe(bytes)
-		if err != nil {
+		if err := t.UnmarshalUnsafe(bytes); err != nil {
 			log.Panicf("invalid trade: %s", err)
 			return
 		}
 		fmt.Println(string(t.MarshalJson()))
-
-	default:
-		log.Printf("invalid message type: %c\n", bytes[0])
 	}
 }
@@ -0,0 +1,45 @@
+#!/bin/sh
+#
+# Measures what the benchmark's own bookkeeping costs. The benches are built at every instrumentation level
+# (see src/instrumentation.h) into build/instrumentation-<level>, the same sweep is run with each build, and
+# every level is compared against the build without instrumentation:
+#
+#   scripts/instrumentation_cost.sh [output-dir]
+#
+# LEVELS selects the levels, 0 is always built as the reference. FLAGS are the options exercising the
+# instrumentation, passed to both pub and sub. The sweep points default to a single IPC point at full rate,
+# where the bookkeeping is the largest share of the work; any sweep.sh variable overrides them.
+
+set -u
+
+LEVELS=${LEVELS:-"1 2"}
+FLAGS=${FLAGS:-"-P -K"}
+
+export CHANNELS=${CHANNELS:-aeron:ipc}
+export PUBLICATIONS=${PUBLICATIONS:-"exclusive shared"}
+export MESSAGE_LENGTHS=${MESSAGE_LENGTHS:-0}
+export BATCHES=${BATCHES:-1}
+export FRAGMENT_LIMITS=${FRAGMENT_LIMITS:-256}
+export TERM_LENGTHS=${TERM_LENGTHS:-16m}
+export IDLE_STRATEGIES=${IDLE_STRATEGIES:-noop}
+export MESSAGES=${MESSAGES:-10m}
+export REPEATS=${REPEATS:-5}
+
+OUT=${1:-results/instrumentation-$(date +%Y%m%d-%H%M%S)}
+mkdir -p "$OUT" || exit 1
+
+for level in 0 $LEVELS; do
+    build="build/instrumentation-$level"
+    echo "== building instrumentation level $level into $build"
+    make BUILD_DIR="$build" INSTRUMENTATION="$level" || exit 1
+
+    PUB="$build/aeron-bench-pub" SUB="$build/aeron-bench-sub" PUB_FLAGS="$FLAGS" SUB_FLAGS="$FLAGS" \
+        ./scripts/sweep.sh "$OUT/level-$level" || exit 1
+done
+
+# the differences of the medians are the cost of each level, a slower level is reported as a regression
+for level in $LEVELS; do
+    echo "== instrumentation level $level against level 0"
+    build/instrumentation-0/aeron-bench-compare -A "$OUT/level-0/results.jsonl" "$OUT/level-$level/results.jsonl" \
+        | tee "$OUT/level-$level.compare.txt"
+done
@@ -0,0 +1,154 @@
+#!/bin/sh
+#
+# Runs aeron-bench-sub and aeron-bench-pub over the cartesian product of the parameters below and collects
+# one JSON record per point in results.jsonl plus a flat results.csv in the output directory.
+#
+#   scripts/sweep.sh [output-dir]
+#
+# Every parameter is a space separated list taken from the environment:
+#
+#   CHANNELS         channels, each run as given with the term length appended
+#   PUBLICATIONS     exclusive and/or shared
+#   MESSAGE_LENGTHS  pub -L, frames are zero padded to this length, 0 keeps the natural frame
+#   BATCHES          pub -b, only swept for exclusive publications
+#   FRAGMENT_LIMITS  sub -f
+#   POLL_MODES       sub -M, assembler, poll, controlled and/or block
+#   TERM_LENGTHS     term-length channel parameter
+#   IDLE_STRATEGIES  idle strategy of the embedded media driver the subscriber runs
+#   CLIENT_IDLE_STRATEGIES  pub and sub -i, back pressure and empty poll idle strategy
+#
+# MESSAGES, RATE (pub -r, empty for as fast as possible), THREADING (driver threading mode) and SETTLE
+# (seconds between starting the subscriber and the publisher) apply to every point. REPEATS runs every point
+# that many times, repeats are what aeron-bench-compare tests a candidate against a baseline with. PUB_FLAGS
+# and SUB_FLAGS are extra options passed as given to every run, e.g. SUB_FLAGS=-P:
+#
+#   REPEATS=5 scripts/sweep.sh results/driver-1.42.0
+#   REPEATS=5 scripts/sweep.sh results/driver-1.42.1
+#   build/aeron-bench-compare results/driver-1.42.0/results.jsonl results/driver-1.42.1/results.jsonl
+
+set -u
+# channels contain ? and must not be globbed when the lists are split
+set -f
+
+CHANNELS=${CHANNELS:-"aeron:ipc aeron:udp?endpoint=localhost:20121 aeron:udp?endpoint=224.0.1.1:40456|interface=localhost"}
+PUBLICATIONS=${PUBLICATIONS:-"exclusive shared"}
+MESSAGE_LENGTHS=${MESSAGE_LENGTHS:-"0 256 1024"}
+BATCHES=${BATCHES:-"1 16"}
+FRAGMENT_LIMITS=${FRAGMENT_LIMITS:-"10 256"}
+POLL_MODES=${POLL_MODES:-assembler}
+TERM_LENGTHS=${TERM_LENGTHS:-"64k 16m"}
+IDLE_STRATEGIES=${IDLE_STRATEGIES:-"noop backoff"}
+CLIENT_IDLE_STRATEGIES=${CLIENT_IDLE_STRATEGIES:-"busy-spin"}
+MESSAGES=${MESSAGES:-1m}
+RATE=${RATE:-}
+THREADING=${THREADING:-dedicated}
+SETTLE=${SETTLE:-1}
+REPEATS=${REPEATS:-1}
+STREAM_ID=${STREAM_ID:-1001}
+PUB=${PUB:-build/aeron-bench-pub}
+SUB=${SUB:-build/aeron-bench-sub}
+PUB_FLAGS=${PUB_FLAGS:-}
+SUB_FLAGS=${SUB_FLAGS:-}
+
+OUT=${1:-results/sweep-$(date +%Y%m%d-%H%M%S)}
+mkdir -p "$OUT/runs" || exit 1
+
+JSONL="$OUT/results.jsonl"
+CSV="$OUT/results.csv"
+: > "$JSONL"
+echo "channel,publication,message_length,batch,fragment_limit,poll_mode,term_length,idle,client_idle,pub_msgs_per_sec,pub_bytes_per_sec,back_pressure_ratio,pub_cpu_cores,sub_msgs_per_sec,sub_cpu_cores,lost,latency_p50_ns,latency_p99_ns,latency_p99_9_ns,latency_p99_99_ns,latency_max_ns" > "$CSV"
+
+# value of a top level key in a flat JSON line, empty when missing
+json_field() {
+    printf '%s\n' "$1" | sed -n "s/.*\"$2\":\([^,}]*\).*/\1/p"
+}
+
+run_point() {
+    channel=$1 publication=$2 length=$3 batch=$4 limit=$5 poll_mode=$6 term=$7 idle=$8 client_idle=$9 run=${10}
+
+    case "$channel" in
+        *\?*) uri="$channel|term-length=$term" ;;
+        *) uri="$channel?term-length=$term" ;;
+    esac
+
+    dir=$(mktemp -d "${TMPDIR:-/dev/shm}/aeron-bench-sweep.XXXXXX") || exit 1
+    rmdir "$dir"
+
+    "$SUB" -J -L -D "$THREADING" -I "$idle" -p "$dir" -c "$uri" -s "$STREAM_ID" -f "$limit" -M "$poll_mode" -i "$client_idle" \
+        -m "$MESSAGES" -T 5s $SUB_FLAGS \
+        > "$OUT/runs/$run.sub.txt" 2>&1 &
+    sub_pid=$!
+
+    # the driver is up once its cnc file exists, then give the subscription time to be added
+    tries=0
+    while [ ! -e "$dir/cnc.dat" ] && [ $tries -lt 100 ] && kill -0 $sub_pid 2>/dev/null; do
+        sleep 0.1
+        tries=$((tries + 1))
+    done
+    sleep "$SETTLE"
+
+    set -- -J -p "$dir" -c "$uri" -s "$STREAM_ID" -m "$MESSAGES" -L "$length" -i "$client_idle" -l 1s
+    [ "$publication" = exclusive ] && set -- "$@" -x -b "$batch"
+    [ -n "$RATE" ] && set -- "$@" -r "$RATE"
+    set -- "$@" $PUB_FLAGS
+    # the subscriber only times out after a first message, stop it when the publisher never sent one
+    "$PUB" "$@" > "$OUT/runs/$run.pub.txt" 2>&1 || kill -INT $sub_pid 2>/dev/null
+    wait $sub_pid
+
+    pub_json=$(grep '^{"role":"pub"' "$OUT/runs/$run.pub.txt")
+    sub_json=$(grep '^{"role":"sub"' "$OUT/runs/$run.sub.txt")
+    if [ -z "$pub_json" ] || [ -z "$sub_json" ]; then
+        echo "point $run failed, see $OUT/runs/$run.*.txt" >&2
+        return
+    fi
+
+    printf '{"point":{"channel":"%s","publication":"%s","message_length":%s,"batch":%s,"fragment_limit":%s,"poll_mode":"%s","term_length":"%s","idle":"%s","client_idle":"%s"},"pub":%s,"sub":%s}\n' \
+        "$channel" "$publication" "$length" "$batch" "$limit" "$poll_mode" "$term" "$idle" "$client_idle" "$pub_json" "$sub_json" >> "$JSONL"
+
+    printf '"%s",%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s\n' \
+        "$channel" "$publication" "$length" "$batch" "$limit" "$poll_mode" "$term" "$idle" "$client_idle" \
+        "$(json_field "$pub_json" msgs_per_sec)" \
+        "$(json_field "$pub_json" bytes_per_sec)" \
+        "$(json_field "$pub_json" back_pressure_ratio)" \
+        "$(json_field "$pub_json" cpu_cores)" \
+        "$(json_field "$sub_json" msgs_per_sec)" \
+        "$(json_field "$sub_json" cpu_cores)" \
+        "$(json_field "$sub_json" lost)" \
+        "$(json_field "$sub_json" latency_p50_ns)" \
+        "$(json_field "$sub_json" latency_p99_ns)" \
+        "$(json_field "$sub_json" latency_p99_9_ns)" \
+        "$(json_field "$sub_json" latency_p99_99_ns)" \
+        "$(json_field "$sub_json" latency_max_ns)" >> "$CSV"
+}
+
+run=0
+for channel in $CHANNELS; do
+    for publication in $PUBLICATIONS; do
+        for length in $MESSAGE_LENGTHS; do
+            for batch in $BATCHES; do
+                # batching needs claims, shared publications offer one frame at a time
+                [ "$publication" = shared ] && [ "$batch" != 1 ] && continue
+                for limit in $FRAGMENT_LIMITS; do
+                    for poll_mode in $POLL_MODES; do
+                        for term in $TERM_LENGTHS; do
+                            for idle in $IDLE_STRATEGIES; do
+                                for client_idle in $CLIENT_IDLE_STRATEGIES; do
+                                    repeat=0
+                                    while [ $repeat -lt "$REPEATS" ]; do
+                                        repeat=$((repeat + 1))
+                                        run=$((run + 1))
+                                        echo "[$run] $channel $publication length $length batch $batch fragments $limit $poll_mode term $term" \
+                                            "idle $idle client idle $client_idle, run $repeat of $REPEATS"
+                                        run_point "$channel" "$publication" "$length" "$batch" "$limit" "$poll_mode" "$term" "$idle" "$client_idle" "$run"
+                                    done
+                                done
+                            done
+                        done
+                    done
+                done
+            done
+        done
+    done
+done
+
+echo "$run runs, results in $JSONL and $CSV"
@@ -0,0 +1,178 @@
+#if defined(__linux__)
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+
+#if defined(AFFINITY_NUMA)
+#include <numa.h>
+#include <numaif.h>
+#endif
+
+#include "affinity.h"
+
+int affinity_parse_cpu_list(const char *str, int *cpus, size_t max_cpus)
+{
+    size_t count = 0;
+    const char *p = str;
+
+    while (*p != '\0')
+    {
+        char *end = NULL;
+        long first = strtol(p, &end, 10);
+        long last = first;
+
+        if (end == p || first < 0)
+        {
+            return -1;
+        }
+
+        if (*end == '-')
+        {
+            p = end + 1;
+            last = strtol(p, &end, 10);
+            if (end == p || last < first)
+            {
+                return -1;
+            }
+        }
+
+        for (long cpu = first; cpu <= last; cpu++)
+        {
+            if (count >= max_cpus)
+            {
+                return -1;
+            }
+            cpus[count++] = (int)cpu;
+        }
+
+        if (*end == ',')
+        {
+            end++;
+        }
+        else if (*end != '\0')
+        {
+            return -1;
+        }
+        p = end;
+    }
+
+    return (int)count;
+}
+
+int affinity_pin_current_thread(int cpu)
+{
+    return affinity_pin_thread(pthread_self(), cpu);
+}
+
+int affinity_pin_thread(pthread_t thread, int cpu)
+{
+    if (cpu < 0)
+    {
+        return 0;
+    }
+
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+
+    int result = pthread_setaffinity_np(thread, sizeof(cpu_set), &cpu_set);
+    if (result != 0)
+    {
+        fprintf(stderr, "pthread_setaffinity_np cpu %d: %s\n", cpu, strerror(result));
+        return -1;
+    }
+
+    return 0;
+}
+
+int affinity_bind_current_thread_to_node(int node)
+{
+    if (node < 0)
+    {
+        return 0;
+    }
+
+#if defined(AFFINITY_NUMA)
+    if (numa_available() < 0)
+    {
+        fprintf(stderr, "affinity_bind_current_thread_to_node: NUMA is not available\n");
+        return -1;
+    }
+
+    if (node > numa_max_node())
+    {
+        fprintf(stderr, "affinity_bind_current_thread_to_node: node %d, the highest node is %d\n", node, numa_max_node());
+        return -1;
+    }
+
+    if (numa_run_on_node(node) < 0)
+    {
+        fprintf(stderr, "numa_run_on_node %d: %s\n", node, strerror(errno));
+        return -1;
+    }
+    numa_set_preferred(node);
+
+    return 0;
+#else
+    fprintf(stderr, "affinity_bind_current_thread_to_node: built without NUMA support (make NUMA=1)\n");
+    return -1;
+#endif
+}
+
+int affinity_cpu_node(int cpu)
+{
+#if defined(AFFINITY_NUMA)
+    if (cpu >= 0 && numa_available() >= 0)
+    {
+        return numa_node_of_cpu(cpu);
+    }
+#else
+    (void)cpu;
+#endif
+    return -1;
+}
+
+int affinity_address_node(const void *address)
+{
+#if defined(AFFINITY_NUMA)
+    int node = -1;
+    if (NULL != address && numa_available() >= 0 &&
+        get_mempolicy(&node, NULL, 0, (void *)address, MPOL_F_NODE | MPOL_F_ADDR) == 0)
+    {
+        return node;
+    }
+#else
+    (void)address;
+#endif
+    return -1;
+}
+
+void affinity_print_placement(const char *label)
+{
+    cpu_set_t cpu_set;
+    int cpu = sched_getcpu();
+    int allowed = -1;
+    int preferred_node = -1;
+
+    CPU_ZERO(&cpu_set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0)
+    {
+        allowed = CPU_COUNT(&cpu_set);
+    }
+
+#if defined(AFFINITY_NUMA)
+    if (numa_available() >= 0)
+    {
+        preferred_node = numa_preferred();
+    }
+#endif
+
+    printf("%s: cpu %d node %d, %d cpus allowed, memory preferred on node %d\n",
+           label, cpu, affinity_cpu_node(cpu), allowed, preferred_node);
+}
@@ -0,0 +1,31 @@
+#ifndef AFFINITY_H
+#define AFFINITY_H
+
+#include <stddef.h>
+#include <pthread.h>
+
+#define AFFINITY_MAX_CPUS (256)
+
+/* Parses a cpu list such as "2,3,8-11" into cpus, returns the number of cpus or -1 if malformed. */
+int affinity_parse_cpu_list(const char *str, int *cpus, size_t max_cpus);
+
+/* Pins the calling thread to one cpu, a negative cpu leaves the affinity unchanged. */
+int affinity_pin_current_thread(int cpu);
+
+/* Pins another thread, such as an agent runner's, to one cpu. */
+int affinity_pin_thread(pthread_t thread, int cpu);
+
+/*
+ * NUMA placement, built with libnuma when AFFINITY_NUMA is defined. Binding runs the calling thread on the
+ * node's cpus and prefers the node for its memory; threads created afterwards inherit both, and memory is
+ * placed when first touched, so buffers written by bound threads end up node-local. A negative node leaves
+ * the placement unchanged. Without libnuma binding fails and nodes are reported as -1.
+ */
+int affinity_bind_current_thread_to_node(int node);
+int affinity_cpu_node(int cpu);
+int affinity_address_node(const void *address);
+
+/* Prints the calling thread's cpu, node, allowed cpus and preferred memory node. */
+void affinity_print_placement(const char *label);
+
+#endif
@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "back_pressure.h"
+
+static const char *back_pressure_reason_names[BACK_PRESSURE_REASON_COUNT] = {
+    "not_connected",
+    "back_pressured",
+    "admin_action",
+    "max_position_exceeded",
+};
+
+const char *back_pressure_reason_name(back_pressure_reason_t reason)
+{
+    return reason < BACK_PRESSURE_REASON_COUNT ? back_pressure_reason_names[reason] : "unknown";
+}
+
+int back_pressure_stats_init(back_pressure_stats_t *stats, bool record_stalls, int64_t window_length)
+{
+    memset(stats, 0, sizeof(back_pressure_stats_t));
+    stats->record_stalls = record_stalls;
+    stats->window_length = window_length;
+
+    if (!record_stalls)
+        return 0;
+
+    for (int i = 0; i < BACK_PRESSURE_REASON_COUNT; i++)
+    {
+        if (histogram_init(&stats->stall_histograms[i], DEFAULT_HISTOGRAM_HIGHEST_TRACKABLE_VALUE, DEFAULT_HISTOGRAM_SIGNIFICANT_FIGURES) < 0)
+            return -1;
+    }
+
+    // lags are in bytes, a term is at most 1GB
+    if (histogram_init(&stats->lag_histogram, INT64_C(1) << 31, DEFAULT_HISTOGRAM_SIGNIFICANT_FIGURES) < 0 ||
+        histogram_init(&stats->stall_lag_histogram, INT64_C(1) << 31, DEFAULT_HISTOGRAM_SIGNIFICANT_FIGURES) < 0)
+        return -1;
+
+    return 0;
+}
+
+void back_pressure_stats_close(back_pressure_stats_t *stats)
+{
+    for (int i = 0; i < BACK_PRESSURE_REASON_COUNT; i++)
+        histogram_close(&stats->stall_histograms[i]);
+    histogram_close(&stats->lag_histogram);
+    histogram_close(&stats->stall_lag_histogram);
+}
+
+void back_pressure_stats_add(back_pressure_stats_t *to, const back_pressure_stats_t *from)
+{
+    for (int i = 0; i < BACK_PRESSURE_REASON_COUNT; i++)
+    {
+        to->attempts[i] += from->attempts[i];
+        if (to->record_stalls)
+            histogram_add(&to->stall_histograms[i], &from->stall_histograms[i]);
+    }
+
+    if (to->record_stalls)
+    {
+        histogram_add(&to->lag_histogram, &from->lag_histogram);
+        histogram_add(&to->stall_lag_histogram, &from->stall_lag_histogram);
+    }
+}
+
+static void back_pressure_print_lag(const char *label, const histogram_t *histogram)
+{
+    printf("    %s: count %" PRId64 " mean %.0f p50 %" PRId64 " p99 %" PRId64 " max %" PRId64 " bytes\n",
+           label,
+           histogram->total_count,
+           histogram_mean(histogram),
+           histogram_value_at_percentile(histogram, 50.0),
+           histogram_value_at_percentile(histogram, 99.0),
+           histogram->max_value);
+}
+
+void back_pressure_stats_print(const char *label, const back_pressure_stats_t *stats)
+{
+    printf("%s:", label);
+    for (int i = 0; i < BACK_PRESSURE_REASON_COUNT; i++)
+        printf(" %s %" PRIu64, back_pressure_reason_names[i], stats->attempts[i]);
+    printf("\n");
+
+    if (!stats->record_stalls)
+        return;
+
+    for (int i = 0; i < BACK_PRESSURE_REASON_COUNT; i++)
+    {
+        const histogram_t *histogram = &stats->stall_histograms[i];
+        if (histogram->total_count == 0)
+            continue;
+
+        printf("    %s stalls (us): count %" PRId64 " mean %.3f p50 %.3f p99 %.3f p99.9 %.3f max %.3f\n",
+               back_pressure_reason_names[i],
+               histogram->total_count,
+               histogram_mean(histogram) / 1000.0,
+               (double)histogram_value_at_percentile(histogram, 50.0) / 1000.0,
+               (double)histogram_value_at_percentile(histogram, 99.0) / 1000.0,
+               (double)histogram_value_at_percentile(histogram, 99.9) / 1000.0,
+               (double)histogram->max_value / 1000.0);
+    }
+
+    printf("    position lag against a window of %" PRId64 " bytes\n", stats->window_length);
+    back_pressure_print_lag("sampled", &stats->lag_histogram);
+    if (stats->stall_lag_histogram.total_count > 0)
+        back_pressure_print_lag("at stall", &stats->stall_lag_histogram);
+}
+
+extern back_pressure_reason_t back_pressure_reason(int64_t result);
+extern void back_pressure_record_lag(back_pressure_stats_t *stats, histogram_t *histogram, int64_t position, int64_t position_limit);
+extern void back_pressure_on_attempt(back_pressure_stats_t *stats, back_pressure_reason_t reason, bool stall_start, int64_t now_ns);
+extern void back_pressure_on_stall_end(back_pressure_stats_t *stats, int64_t now_ns);
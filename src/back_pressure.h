@@ -0,0 +1,92 @@
+#ifndef BACK_PRESSURE_H
+#define BACK_PRESSURE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <aeronc.h>
+
+#include "histogram.h"
+
+/* Messages between two samples of the position lag, a power of two. */
+#define BACK_PRESSURE_LAG_SAMPLE_INTERVAL (1024)
+
+/* The failed claim and offer results a publisher waits out, a closed or failed publication ends the run. */
+typedef enum back_pressure_reason_en
+{
+    BACK_PRESSURE_NOT_CONNECTED = 0,
+    BACK_PRESSURE_BACK_PRESSURED = 1,
+    BACK_PRESSURE_ADMIN_ACTION = 2,
+    BACK_PRESSURE_MAX_POSITION_EXCEEDED = 3,
+    BACK_PRESSURE_REASON_COUNT
+} back_pressure_reason_t;
+
+/*
+ * Why and for how long a publisher could not claim or offer. Every failed attempt is counted by reason.
+ * With record_stalls a stall, from the first failed attempt to the next success or the end of the run, is
+ * timed into the histogram of the reason it started with, and the position lag is sampled: how far the
+ * publication's consumer trails it, an IPC subscriber or the sender of a network publication. The lag is the publication position minus
+ * its limit plus the window the driver grants ahead of the consumer, half a term unless configured otherwise.
+ * Stalls that start with the lag at the window are the consumer or sender holding the publisher back, admin
+ * actions are term rotations whatever the lag.
+ */
+typedef struct back_pressure_stats_stct
+{
+    uint64_t attempts[BACK_PRESSURE_REASON_COUNT];
+    histogram_t stall_histograms[BACK_PRESSURE_REASON_COUNT];
+    histogram_t lag_histogram;
+    histogram_t stall_lag_histogram;
+    int64_t window_length;
+    int64_t stall_start_ns;
+    back_pressure_reason_t stall_reason;
+    bool record_stalls;
+    bool stalled;
+} back_pressure_stats_t;
+
+int back_pressure_stats_init(back_pressure_stats_t *stats, bool record_stalls, int64_t window_length);
+/* Safe on zeroed stats that were never initialised. */
+void back_pressure_stats_close(back_pressure_stats_t *stats);
+/* Folds the stats of a thread into to, both initialised with the same record_stalls. */
+void back_pressure_stats_add(back_pressure_stats_t *to, const back_pressure_stats_t *from);
+const char *back_pressure_reason_name(back_pressure_reason_t reason);
+void back_pressure_stats_print(const char *label, const back_pressure_stats_t *stats);
+
+inline back_pressure_reason_t back_pressure_reason(int64_t result)
+{
+    switch (result)
+    {
+    case AERON_PUBLICATION_NOT_CONNECTED:
+        return BACK_PRESSURE_NOT_CONNECTED;
+    case AERON_PUBLICATION_ADMIN_ACTION:
+        return BACK_PRESSURE_ADMIN_ACTION;
+    case AERON_PUBLICATION_MAX_POSITION_EXCEEDED:
+        return BACK_PRESSURE_MAX_POSITION_EXCEEDED;
+    default:
+        return BACK_PRESSURE_BACK_PRESSURED;
+    }
+}
+
+inline void back_pressure_record_lag(back_pressure_stats_t *stats, histogram_t *histogram, int64_t position, int64_t position_limit)
+{
+    histogram_record_value(histogram, position - position_limit + stats->window_length);
+}
+
+/* Counts a failed attempt, the first of a stall is stamped with now_ns when stalls are recorded. */
+inline void back_pressure_on_attempt(back_pressure_stats_t *stats, back_pressure_reason_t reason, bool stall_start, int64_t now_ns)
+{
+    stats->attempts[reason]++;
+    if (stall_start)
+    {
+        stats->stall_start_ns = now_ns;
+        stats->stall_reason = reason;
+        stats->stalled = true;
+    }
+}
+
+inline void back_pressure_on_stall_end(back_pressure_stats_t *stats, int64_t now_ns)
+{
+    stats->stalled = false;
+    histogram_record_value(&stats->stall_histograms[stats->stall_reason], now_ns - stats->stall_start_ns);
+}
+
+#endif
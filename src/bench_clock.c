@@ -0,0 +1,202 @@
+#if defined(__linux__)
+#define _DEFAULT_SOURCE
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+#include <aeronc.h>
+
+#include "bench_clock.h"
+
+#if defined(BENCH_CLOCK_HAS_TSC)
+
+/* CPUID 0x80000007 EDX bit 8, the TSC ticks at a constant rate through frequency and sleep state changes. */
+static bool bench_clock_tsc_invariant(void)
+{
+    unsigned int eax, ebx, ecx, edx;
+
+    if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0)
+        return false;
+
+    return (edx & (1u << 8)) != 0;
+}
+
+/* A TSC and CLOCK_MONOTONIC pair, the narrowest of a few brackets so a preemption does not skew it. */
+static void bench_clock_sample(uint64_t *tsc, int64_t *ns)
+{
+    uint64_t best_width = UINT64_MAX;
+
+    for (int i = 0; i < 5; i++)
+    {
+        uint64_t before = bench_clock_tsc();
+        int64_t now_ns = aeron_nano_clock();
+        uint64_t after = bench_clock_tsc();
+
+        if (after - before < best_width)
+        {
+            best_width = after - before;
+            *tsc = before + (after - before) / 2;
+            *ns = now_ns;
+        }
+    }
+}
+
+void bench_clock_recheck(bench_clock_t *clock)
+{
+    uint64_t tsc = 0;
+    int64_t ns = 0;
+
+    bench_clock_sample(&tsc, &ns);
+
+    int64_t predicted_ns = clock->base_ns + (int64_t)((double)(int64_t)(tsc - clock->base_tsc) * clock->ns_per_tick);
+    int64_t drift_ns = ns > predicted_ns ? ns - predicted_ns : predicted_ns - ns;
+    if (drift_ns > clock->max_drift_ns)
+        clock->max_drift_ns = drift_ns;
+    clock->check_count++;
+
+    // the longer the baseline the better the rate, so it is taken from the first sample every time
+    if (tsc > clock->start_tsc && ns > clock->start_ns)
+        clock->measured_ns_per_tick = (double)(ns - clock->start_ns) / (double)(tsc - clock->start_tsc);
+    clock->ns_per_tick = clock->measured_ns_per_tick;
+
+    // stepping back onto the sample would hand out an earlier stamp than one already taken, so a clock that is
+    // ahead carries on from where it is and runs slower until the next check, at no less than half speed
+    if (predicted_ns > ns)
+    {
+        double slew = 1.0 - (double)(predicted_ns - ns) / (double)BENCH_CLOCK_CHECK_INTERVAL_NS;
+        clock->ns_per_tick *= slew > 0.5 ? slew : 0.5;
+        ns = predicted_ns;
+    }
+
+    clock->base_tsc = tsc;
+    clock->base_ns = ns;
+    clock->next_check_tsc = tsc + clock->check_interval_ticks;
+}
+
+static int bench_clock_calibrate(bench_clock_t *clock)
+{
+    uint64_t end_tsc = 0;
+    int64_t end_ns = 0;
+
+    bench_clock_sample(&clock->start_tsc, &clock->start_ns);
+    while (aeron_nano_clock() - clock->start_ns < BENCH_CLOCK_CALIBRATION_NS)
+        ;
+    bench_clock_sample(&end_tsc, &end_ns);
+
+    if (end_tsc <= clock->start_tsc)
+    {
+        fprintf(stderr, "bench_clock_init: TSC did not advance during calibration\n");
+        return -1;
+    }
+
+    clock->ns_per_tick = (double)(end_ns - clock->start_ns) / (double)(end_tsc - clock->start_tsc);
+    clock->measured_ns_per_tick = clock->ns_per_tick;
+    clock->base_tsc = end_tsc;
+    clock->base_ns = end_ns;
+    clock->check_interval_ticks = (uint64_t)((double)BENCH_CLOCK_CHECK_INTERVAL_NS / clock->ns_per_tick);
+    clock->next_check_tsc = end_tsc + clock->check_interval_ticks;
+
+    return 0;
+}
+
+#else
+
+void bench_clock_recheck(bench_clock_t *clock)
+{
+    (void)clock;
+}
+
+#endif
+
+int bench_clock_init(bench_clock_t *clock, const char *spec)
+{
+    memset(clock, 0, sizeof(bench_clock_t));
+
+    if (strcmp(spec, "monotonic") == 0)
+    {
+        snprintf(clock->name, sizeof(clock->name), "monotonic");
+        return 0;
+    }
+
+    if (strcmp(spec, "tsc") != 0 && strcmp(spec, "auto") != 0)
+    {
+        fprintf(stderr, "bench_clock_init: unknown clock %s\n", spec);
+        return -1;
+    }
+
+#if defined(BENCH_CLOCK_HAS_TSC)
+    if (bench_clock_tsc_invariant())
+    {
+        if (bench_clock_calibrate(clock) < 0)
+            return -1;
+
+        clock->use_tsc = true;
+        snprintf(clock->name, sizeof(clock->name), "tsc");
+        return 0;
+    }
+#endif
+
+    if (strcmp(spec, "tsc") == 0)
+    {
+        fprintf(stderr, "bench_clock_init: no invariant TSC on this CPU\n");
+        return -1;
+    }
+
+    snprintf(clock->name, sizeof(clock->name), "monotonic");
+    return 0;
+}
+
+double bench_clock_read_cost_ns(const bench_clock_t *clock, uint64_t reads)
+{
+    bench_clock_t copy = *clock;
+    volatile int64_t sink = 0;
+
+    int64_t start_ns = aeron_nano_clock();
+    for (uint64_t i = 0; i < reads; i++)
+        sink = bench_clock_ns(&copy);
+    int64_t duration_ns = aeron_nano_clock() - start_ns;
+    (void)sink;
+
+    return reads > 0 ? (double)duration_ns / (double)reads : 0.0;
+}
+
+double bench_clock_print_read_cost(const bench_clock_t *clock)
+{
+    bench_clock_t monotonic = {0};
+    double read_ns = bench_clock_read_cost_ns(clock, BENCH_CLOCK_OVERHEAD_READS);
+    double monotonic_read_ns = bench_clock_read_cost_ns(&monotonic, BENCH_CLOCK_OVERHEAD_READS);
+
+    printf("Clock read cost: %s %.2f ns, monotonic %.2f ns\n", clock->name, read_ns, monotonic_read_ns);
+
+    return read_ns;
+}
+
+void bench_clock_print_report(const bench_clock_t *clock)
+{
+    if (!clock->use_tsc)
+    {
+        printf("Clock: monotonic\n");
+        return;
+    }
+
+    printf("Clock: tsc at %.4f GHz, %" PRIu64 " drift checks, max drift %" PRId64 " ns\n",
+           1.0 / clock->measured_ns_per_tick, clock->check_count, clock->max_drift_ns);
+}
+
+void bench_clock_add_checks(bench_clock_t *to, const bench_clock_t *from)
+{
+    to->check_count += from->check_count;
+    if (from->max_drift_ns > to->max_drift_ns)
+        to->max_drift_ns = from->max_drift_ns;
+}
+
+#if defined(BENCH_CLOCK_HAS_TSC)
+extern uint64_t bench_clock_tsc(void);
+#endif
+extern int64_t bench_clock_ns(bench_clock_t *clock);
@@ -0,0 +1,83 @@
+#ifndef BENCH_CLOCK_H
+#define BENCH_CLOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <aeronc.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_CLOCK_HAS_TSC
+#endif
+
+/* Time spent spinning between the two samples of the startup calibration. */
+#define BENCH_CLOCK_CALIBRATION_NS (INT64_C(20) * 1000 * 1000)
+/* How often a TSC clock is compared with CLOCK_MONOTONIC again, by the thread reading it. */
+#define BENCH_CLOCK_CHECK_INTERVAL_NS (INT64_C(100) * 1000 * 1000)
+/* Reads timed for the clock overhead report. */
+#define BENCH_CLOCK_OVERHEAD_READS (10 * 1000 * 1000)
+
+/*
+ * Nanosecond clock for stamping and measuring on the hot paths. With an invariant TSC it is read with
+ * rdtscp and scaled onto CLOCK_MONOTONIC, so stamps stay comparable with aeron_nano_clock() and with another
+ * process on the same host. Every BENCH_CLOCK_CHECK_INTERVAL_NS the reading thread takes a fresh CLOCK_MONOTONIC
+ * sample, records how far the TSC had drifted from it and refines the rate over the whole run. A clock found
+ * behind steps forward onto the sample, one found ahead is never stepped back but slewed, read slower until the
+ * next check so it meets CLOCK_MONOTONIC again. Otherwise it is aeron_nano_clock(). Not thread safe, every thread
+ * copies the calibrated clock.
+ */
+typedef struct bench_clock_stct
+{
+    bool use_tsc;
+    double ns_per_tick;
+    double measured_ns_per_tick;
+    uint64_t base_tsc;
+    int64_t base_ns;
+    uint64_t start_tsc;
+    int64_t start_ns;
+    uint64_t next_check_tsc;
+    uint64_t check_interval_ticks;
+    uint64_t check_count;
+    int64_t max_drift_ns;
+    char name[16];
+} bench_clock_t;
+
+/* spec is tsc, monotonic or auto, auto takes the TSC when it is invariant. */
+int bench_clock_init(bench_clock_t *clock, const char *spec);
+void bench_clock_recheck(bench_clock_t *clock);
+/* Average cost of one read in nanoseconds over reads reads of a copy of clock. */
+double bench_clock_read_cost_ns(const bench_clock_t *clock, uint64_t reads);
+/* Prints the read cost of clock and of CLOCK_MONOTONIC for comparison, returns the cost of clock. */
+double bench_clock_print_read_cost(const bench_clock_t *clock);
+void bench_clock_print_report(const bench_clock_t *clock);
+/* Folds the drift checks of a per-thread copy into to. */
+void bench_clock_add_checks(bench_clock_t *to, const bench_clock_t *from);
+
+#if defined(BENCH_CLOCK_HAS_TSC)
+/* rdtscp waits for earlier instructions, so an end stamp is not taken before the work it measures. */
+inline uint64_t bench_clock_tsc(void)
+{
+    unsigned int aux;
+    return __rdtscp(&aux);
+}
+#endif
+
+inline int64_t bench_clock_ns(bench_clock_t *clock)
+{
+#if defined(BENCH_CLOCK_HAS_TSC)
+    if (clock->use_tsc)
+    {
+        uint64_t tsc = bench_clock_tsc();
+        if (tsc >= clock->next_check_tsc)
+            bench_clock_recheck(clock);
+
+        return clock->base_ns + (int64_t)((double)(int64_t)(tsc - clock->base_tsc) * clock->ns_per_tick);
+    }
+#else
+    (void)clock;
+#endif
+    return aeron_nano_clock();
+}
+
+#endif
@@ -0,0 +1,131 @@
+#if defined(__linux__)
+#define _DEFAULT_SOURCE
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include <aeronc.h>
+
+#include "bench_counters.h"
+
+static const char *bench_counter_kind_names[BENCH_COUNTER_KIND_COUNT] = {
+    "messages",
+    "bytes",
+    "back pressure",
+    "claims",
+    "gaps",
+    "lost",
+    "malformed fragments",
+    "latency p50 ns",
+    "latency p99 ns",
+    "latency p99.9 ns",
+    "latency max ns",
+};
+
+const char *bench_counter_kind_name(bench_counter_kind_t kind)
+{
+    return kind < BENCH_COUNTER_KIND_COUNT ? bench_counter_kind_names[kind] : "unknown";
+}
+
+int bench_counters_init(
+    bench_counters_t *counters,
+    aeron_t *aeron,
+    const char *role,
+    int32_t stream_id,
+    int32_t index,
+    const bench_counter_kind_t *kinds,
+    size_t kind_count)
+{
+    aeron_async_add_counter_t *asyncs[BENCH_COUNTER_KIND_COUNT] = {0};
+    bench_counter_key_t key = {.pid = (int32_t)getpid(), .stream_id = stream_id, .index = index};
+
+    memset(counters, 0, sizeof(bench_counters_t));
+    counters->first_counter_id = INT32_MAX;
+    counters->last_counter_id = -1;
+
+    // all adds are in flight together, so setting up the counters is one round trip to the driver
+    for (size_t i = 0; i < kind_count; i++)
+    {
+        char label[128];
+        int label_length = snprintf(label, sizeof(label), "aeron-bench-%s %s: stream=%" PRId32 " index=%" PRId32 " pid=%" PRId32,
+                                    role, bench_counter_kind_name(kinds[i]), stream_id, index, key.pid);
+
+        if (aeron_async_add_counter(
+                &asyncs[kinds[i]],
+                aeron,
+                BENCH_COUNTER_TYPE_ID + (int32_t)kinds[i],
+                (const uint8_t *)&key,
+                sizeof(key),
+                label,
+                (size_t)label_length < sizeof(label) ? (size_t)label_length : sizeof(label) - 1) < 0)
+        {
+            fprintf(stderr, "aeron_async_add_counter: %s\n", aeron_errmsg());
+            goto error;
+        }
+    }
+
+    for (size_t i = 0; i < kind_count; i++)
+    {
+        bench_counter_kind_t kind = kinds[i];
+        aeron_counter_constants_t constants;
+
+        while (NULL == counters->counters[kind])
+        {
+            int result = aeron_async_add_counter_poll(&counters->counters[kind], asyncs[kind]);
+            if (result != 0)
+                asyncs[kind] = NULL;
+            if (result < 0)
+            {
+                fprintf(stderr, "aeron_async_add_counter_poll: %s\n", aeron_errmsg());
+                goto error;
+            }
+            sched_yield();
+        }
+
+        counters->addresses[kind] = aeron_counter_addr(counters->counters[kind]);
+        if (aeron_counter_constants(counters->counters[kind], &constants) == 0)
+        {
+            if (constants.counter_id < counters->first_counter_id)
+                counters->first_counter_id = constants.counter_id;
+            if (constants.counter_id > counters->last_counter_id)
+                counters->last_counter_id = constants.counter_id;
+        }
+    }
+
+    return 0;
+
+error:
+    // the adds still in flight would leave their counters behind in the driver, wait them out so they get closed too
+    for (size_t i = 0; i < BENCH_COUNTER_KIND_COUNT; i++)
+    {
+        while (NULL != asyncs[i])
+        {
+            if (aeron_async_add_counter_poll(&counters->counters[i], asyncs[i]) != 0)
+                asyncs[i] = NULL;
+            else
+                sched_yield();
+        }
+    }
+
+    bench_counters_close(counters);
+    return -1;
+}
+
+void bench_counters_close(bench_counters_t *counters)
+{
+    for (size_t i = 0; i < BENCH_COUNTER_KIND_COUNT; i++)
+    {
+        if (NULL != counters->counters[i])
+        {
+            aeron_counter_close(counters->counters[i], NULL, NULL);
+            counters->counters[i] = NULL;
+            counters->addresses[i] = NULL;
+        }
+    }
+}
+
+extern void bench_counters_set(bench_counters_t *counters, bench_counter_kind_t kind, int64_t value);
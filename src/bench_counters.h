@@ -0,0 +1,71 @@
+#ifndef BENCH_COUNTERS_H
+#define BENCH_COUNTERS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <aeronc.h>
+#include <concurrent/aeron_atomic.h>
+
+/*
+ * Type ids of the counters the benches add to the CnC file, BENCH_COUNTER_TYPE_ID + the kind. They are above
+ * the range Aeron uses for its own counters, so tools can pick them out by type id alone.
+ */
+#define BENCH_COUNTER_TYPE_ID (10100)
+
+/* Hot threads publish their totals every this many claims, offers or polls, and once at the end. */
+#define BENCH_COUNTERS_UPDATE_INTERVAL (1024)
+
+typedef enum bench_counter_kind_en
+{
+    BENCH_COUNTER_MESSAGES = 0,
+    BENCH_COUNTER_BYTES = 1,
+    BENCH_COUNTER_BACK_PRESSURE = 2,
+    BENCH_COUNTER_CLAIMS = 3,
+    BENCH_COUNTER_GAPS = 4,
+    BENCH_COUNTER_LOST = 5,
+    BENCH_COUNTER_MALFORMED = 6,
+    BENCH_COUNTER_LATENCY_P50_NS = 7,
+    BENCH_COUNTER_LATENCY_P99_NS = 8,
+    BENCH_COUNTER_LATENCY_P99_9_NS = 9,
+    BENCH_COUNTER_LATENCY_MAX_NS = 10,
+    BENCH_COUNTER_KIND_COUNT
+} bench_counter_kind_t;
+
+/* Key of every bench counter, so readers can tell processes, streams and publisher threads apart. */
+typedef struct bench_counter_key_stct
+{
+    int32_t pid;
+    int32_t stream_id;
+    int32_t index;
+} bench_counter_key_t;
+
+/*
+ * One set of counters written by a single thread. Only the kinds passed to init are added, setting any
+ * other kind is an error.
+ */
+typedef struct bench_counters_stct
+{
+    aeron_counter_t *counters[BENCH_COUNTER_KIND_COUNT];
+    int64_t *addresses[BENCH_COUNTER_KIND_COUNT];
+    int32_t first_counter_id;
+    int32_t last_counter_id;
+} bench_counters_t;
+
+int bench_counters_init(
+    bench_counters_t *counters,
+    aeron_t *aeron,
+    const char *role,
+    int32_t stream_id,
+    int32_t index,
+    const bench_counter_kind_t *kinds,
+    size_t kind_count);
+void bench_counters_close(bench_counters_t *counters);
+const char *bench_counter_kind_name(bench_counter_kind_t kind);
+
+inline void bench_counters_set(bench_counters_t *counters, bench_counter_kind_t kind, int64_t value)
+{
+    AERON_PUT_ORDERED(*counters->addresses[kind], value);
+}
+
+#endif
@@ -0,0 +1,30 @@
+#include "bench_message.h"
+
+const struct nms_opra_trade_t bench_sample_trade = {
+    .symbol = "AAPL",
+    .condition = 'a',
+    .exchange = 'A',
+    .strike_price = 123456,
+    .premium_price = 987654,
+    .volume = 111,
+    .expiration = {'T', 23, 18}, // 2023-08-18 Put
+};
+
+const struct nms_opra_quote_t bench_sample_quote = {
+    .symbol = "AAPL",
+    .condition = 'a',
+    .bid_price = 123456,
+    .ask_price = 987654,
+    .bid_size = 111,
+    .ask_size = 999,
+    .bid_exchange = 'A',
+    .ask_exchange = 'Z',
+    .expiration = {'L', 23, 18}, // 2023-12-18 Call
+};
+
+extern void bench_write_frame_header(uint8_t *buffer, uint64_t sequence, uint16_t source_id, uint16_t count);
+extern void bench_write_warm_up_end(uint8_t *buffer, uint64_t sequence, uint16_t source_id, uint16_t sources);
+extern const struct bench_warm_up_end_t *bench_warm_up_end(const uint8_t *buffer, size_t length);
+extern size_t bench_typed_message_length(uint8_t type);
+extern XC_HITIME bench_typed_message_timestamp(const uint8_t *message);
+extern XC_HITIME bench_message_timestamp(const uint8_t *buffer, size_t length);
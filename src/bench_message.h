@@ -0,0 +1,126 @@
+#ifndef BENCH_MESSAGE_H
+#define BENCH_MESSAGE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "nms_messages.h"
+#include "xtypes.h"
+
+#define NMS_OPRA_TRADE_TYPE ('t')
+#define NMS_OPRA_QUOTE_TYPE ('q')
+#define BENCH_WARM_UP_END_TYPE ('W')
+
+#define NMS_OPRA_TRADE_LENGTH (sizeof(struct nms_opra_trade_t))
+#define NMS_OPRA_QUOTE_LENGTH (sizeof(struct nms_opra_quote_t))
+
+#if defined(__linux__) || defined(_MSC_VER)
+#pragma pack(push, 1)
+#else
+#pragma pack(1)
+#endif
+
+/*
+ * Every fragment starts with a frame header followed by count typed messages, each a type byte and the
+ * packed struct. Messages in a frame carry consecutive sequence numbers, counted per source within a session.
+ * Bytes after the count messages are zero padding, used to sweep the fragment size. Warm-up frames have
+ * BENCH_WARM_UP_SOURCE_FLAG set in their source_id, so they are told apart before any marker arrives.
+ */
+struct bench_frame_header_t // 12
+{
+    xuint64 sequence;  //  0- 7 sequence of the first message in the frame
+    xuint16 source_id; //  8- 9 publisher thread within the session
+    xuint16 count;     // 10-11 number of typed messages in the frame
+};
+
+/*
+ * End of a source's warm-up, a frame of count 0 followed by this body. Its sequence is the first of the
+ * measured messages. sources is the number of sources warming up on the stream, so the subscriber knows how
+ * many markers to wait for before every source is measured.
+ */
+struct bench_warm_up_end_t // 3
+{
+    xuint8 type;     // 0   BENCH_WARM_UP_END_TYPE
+    xuint16 sources; // 1-2 sources publishing on the stream
+};
+
+#if defined(__linux__) || defined(_MSC_VER)
+#pragma pack(pop)
+#else
+#pragma pack()
+#endif
+
+#define BENCH_WARM_UP_SOURCE_FLAG (UINT16_C(0x8000))
+#define BENCH_SOURCE_ID_MASK (UINT16_C(0x7fff))
+
+#define BENCH_FRAME_HEADER_LENGTH (sizeof(struct bench_frame_header_t))
+#define BENCH_FRAME_MAX_LENGTH (BENCH_FRAME_HEADER_LENGTH + 1 + sizeof(union option_t))
+#define BENCH_WARM_UP_END_LENGTH (BENCH_FRAME_HEADER_LENGTH + sizeof(struct bench_warm_up_end_t))
+
+/* Template messages the publishers start from, mutated per message. */
+extern const struct nms_opra_trade_t bench_sample_trade;
+extern const struct nms_opra_quote_t bench_sample_quote;
+
+inline void bench_write_frame_header(uint8_t *buffer, uint64_t sequence, uint16_t source_id, uint16_t count)
+{
+    struct bench_frame_header_t *frame = (struct bench_frame_header_t *)buffer;
+
+    frame->sequence = sequence;
+    frame->source_id = source_id;
+    frame->count = count;
+}
+
+inline void bench_write_warm_up_end(uint8_t *buffer, uint64_t sequence, uint16_t source_id, uint16_t sources)
+{
+    struct bench_warm_up_end_t *body = (struct bench_warm_up_end_t *)(buffer + BENCH_FRAME_HEADER_LENGTH);
+
+    bench_write_frame_header(buffer, sequence, source_id, 0);
+    body->type = BENCH_WARM_UP_END_TYPE;
+    body->sources = sources;
+}
+
+/* The marker body, or NULL for any other frame. Only frames of count 0 need the check. */
+inline const struct bench_warm_up_end_t *bench_warm_up_end(const uint8_t *buffer, size_t length)
+{
+    if (length < BENCH_WARM_UP_END_LENGTH || ((const struct bench_frame_header_t *)buffer)->count != 0 ||
+        buffer[BENCH_FRAME_HEADER_LENGTH] != BENCH_WARM_UP_END_TYPE)
+        return NULL;
+
+    return (const struct bench_warm_up_end_t *)(buffer + BENCH_FRAME_HEADER_LENGTH);
+}
+
+inline size_t bench_typed_message_length(uint8_t type)
+{
+    switch (type)
+    {
+    case NMS_OPRA_TRADE_TYPE:
+        return NMS_OPRA_TRADE_LENGTH + 1;
+    case NMS_OPRA_QUOTE_TYPE:
+        return NMS_OPRA_QUOTE_LENGTH + 1;
+    default:
+        return 0;
+    }
+}
+
+/* Both structs keep the timestamp at the same offset. */
+inline XC_HITIME bench_typed_message_timestamp(const uint8_t *message)
+{
+    return ((const struct nms_opra_trade_t *)(message + 1))->timestamp;
+}
+
+/* Publisher timestamp of the first message in a frame, 0 if the layout is not recognised. */
+inline XC_HITIME bench_message_timestamp(const uint8_t *buffer, size_t length)
+{
+    if (length <= BENCH_FRAME_HEADER_LENGTH)
+        return 0;
+
+    const uint8_t *message = buffer + BENCH_FRAME_HEADER_LENGTH;
+    size_t message_length = bench_typed_message_length(message[0]);
+    if (message_length == 0 || BENCH_FRAME_HEADER_LENGTH + message_length > length)
+        return 0;
+
+    return bench_typed_message_timestamp(message);
+}
+
+#endif
@@ -0,0 +1,6 @@
+#include "bench_random.h"
+
+extern void bench_random_init(bench_random_t *random, uint64_t seed);
+extern uint64_t bench_random_next(bench_random_t *random);
+extern double bench_random_double(bench_random_t *random);
+extern uint64_t bench_random_below(bench_random_t *random, uint64_t bound);
@@ -0,0 +1,47 @@
+#ifndef BENCH_RANDOM_H
+#define BENCH_RANDOM_H
+
+#include <stdint.h>
+
+/* xorshift64* generator, deterministic for a given seed so generated feeds and schedules are repeatable. */
+typedef struct bench_random_stct
+{
+    uint64_t state;
+} bench_random_t;
+
+inline void bench_random_init(bench_random_t *random, uint64_t seed)
+{
+    // splitmix64 step so small seeds still start from a well mixed, non-zero state
+    uint64_t z = seed + UINT64_C(0x9E3779B97F4A7C15);
+    z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+    z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+    z ^= z >> 31;
+
+    random->state = z != 0 ? z : 1;
+}
+
+inline uint64_t bench_random_next(bench_random_t *random)
+{
+    uint64_t x = random->state;
+
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    random->state = x;
+
+    return x * UINT64_C(0x2545F4914F6CDD1D);
+}
+
+/* Uniform in [0, 1). */
+inline double bench_random_double(bench_random_t *random)
+{
+    return (double)(bench_random_next(random) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* Uniform in [0, bound), bound must be non-zero. */
+inline uint64_t bench_random_below(bench_random_t *random, uint64_t bound)
+{
+    return (uint64_t)(bench_random_double(random) * (double)bound);
+}
+
+#endif
@@ -0,0 +1,177 @@
+#include <stdlib.h>
+#include <math.h>
+
+#include <aeronc.h>
+#include <aeron_alloc.h>
+
+#include "bench_stats.h"
+
+typedef struct ranked_sample_stct
+{
+    double value;
+    int group;
+} ranked_sample_t;
+
+static int bench_stats_compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static int bench_stats_compare_ranked(const void *a, const void *b)
+{
+    return bench_stats_compare_double(&((const ranked_sample_t *)a)->value, &((const ranked_sample_t *)b)->value);
+}
+
+double bench_stats_median(double *values, size_t count)
+{
+    if (count == 0)
+        return NAN;
+
+    qsort(values, count, sizeof(double), bench_stats_compare_double);
+
+    return count % 2 != 0 ? values[count / 2] : (values[count / 2 - 1] + values[count / 2]) / 2.0;
+}
+
+/*
+ * Two-sided p of u from the exact distribution of U, by counting the orderings of a_count and b_count
+ * distinct samples that give each U. The last sample is either one of a, beating every one of b, or one of b:
+ * N(i, j, u) = N(i - 1, j, u - j) + N(i, j - 1, u), kept for one i at a time.
+ */
+static int bench_stats_exact_p_value(size_t a_count, size_t b_count, double u, double *p_value)
+{
+    size_t u_count = a_count * b_count + 1;
+    double *previous = NULL, *current = NULL;
+
+    if (aeron_alloc((void **)&previous, sizeof(double) * (b_count + 1) * u_count) < 0 ||
+        aeron_alloc((void **)&current, sizeof(double) * (b_count + 1) * u_count) < 0)
+    {
+        aeron_free(previous);
+        return -1;
+    }
+
+    // no sample of a, a single ordering with U 0 for every j
+    for (size_t j = 0; j <= b_count; j++)
+        previous[j * u_count] = 1.0;
+
+    for (size_t i = 1; i <= a_count; i++)
+    {
+        for (size_t j = 0; j <= b_count; j++)
+        {
+            for (size_t v = 0; v < u_count; v++)
+            {
+                double count = v >= j ? previous[j * u_count + v - j] : 0.0;
+                if (j > 0)
+                    count += current[(j - 1) * u_count + v];
+                current[j * u_count + v] = count;
+            }
+        }
+
+        double *swap = previous;
+        previous = current;
+        current = swap;
+    }
+
+    const double *counts = previous + b_count * u_count;
+    double total = 0.0, lower = 0.0, upper = 0.0;
+    for (size_t v = 0; v < u_count; v++)
+    {
+        total += counts[v];
+        if ((double)v <= u)
+            lower += counts[v];
+        if ((double)v >= u)
+            upper += counts[v];
+    }
+
+    aeron_free(previous);
+    aeron_free(current);
+
+    *p_value = fmin(1.0, 2.0 * fmin(lower, upper) / total);
+
+    return 0;
+}
+
+double bench_stats_mann_whitney_min_p_value(size_t a_count, size_t b_count)
+{
+    if (a_count == 0 || b_count == 0)
+        return 1.0;
+
+    // 2 of the (a_count + b_count choose a_count) orderings are as extreme as can be
+    double log_orderings = lgamma((double)(a_count + b_count + 1)) - lgamma((double)(a_count + 1)) - lgamma((double)(b_count + 1));
+
+    return fmin(1.0, 2.0 * exp(-log_orderings));
+}
+
+int bench_stats_mann_whitney(const double *a, size_t a_count, const double *b, size_t b_count, mann_whitney_t *result)
+{
+    size_t n = a_count + b_count;
+    ranked_sample_t *samples = NULL;
+
+    result->exact = false;
+    if (a_count == 0 || b_count == 0)
+    {
+        result->u = result->z = 0.0;
+        result->p_value = 1.0;
+        return 0;
+    }
+
+    if (aeron_alloc((void **)&samples, sizeof(ranked_sample_t) * n) < 0)
+    {
+        return -1;
+    }
+
+    for (size_t i = 0; i < a_count; i++)
+        samples[i] = (ranked_sample_t){.value = a[i], .group = 0};
+    for (size_t i = 0; i < b_count; i++)
+        samples[a_count + i] = (ranked_sample_t){.value = b[i], .group = 1};
+    qsort(samples, n, sizeof(ranked_sample_t), bench_stats_compare_ranked);
+
+    // tied values share the mean of their ranks, and each run of ties shrinks the variance
+    double a_rank_sum = 0.0, tie_term = 0.0;
+    for (size_t i = 0; i < n;)
+    {
+        size_t j = i + 1;
+        while (j < n && samples[j].value == samples[i].value)
+            j++;
+
+        double rank = (double)(i + 1 + j) / 2.0, ties = (double)(j - i);
+        for (size_t k = i; k < j; k++)
+        {
+            if (samples[k].group == 0)
+                a_rank_sum += rank;
+        }
+        tie_term += ties * ties * ties - ties;
+        i = j;
+    }
+
+    aeron_free(samples);
+
+    double na = (double)a_count, nb = (double)b_count, total = (double)n;
+    double mean = na * nb / 2.0;
+    double variance = na * nb / 12.0 * ((total + 1.0) - tie_term / (total * (total - 1.0)));
+
+    result->u = a_rank_sum - na * (na + 1.0) / 2.0;
+    if (tie_term == 0.0 && a_count <= BENCH_STATS_EXACT_MAX_COUNT && b_count <= BENCH_STATS_EXACT_MAX_COUNT)
+    {
+        // the normal approximation can not reach a small p with few runs, 3 against 3 never goes below 0.08
+        result->z = 0.0;
+        result->exact = true;
+        return bench_stats_exact_p_value(a_count, b_count, result->u, &result->p_value);
+    }
+
+    if (variance <= 0.0)
+    {
+        // every sample is the same value
+        result->z = 0.0;
+        result->p_value = 1.0;
+        return 0;
+    }
+
+    double distance = fabs(result->u - mean) - 0.5; // continuity correction
+    result->z = (distance > 0.0 ? distance : 0.0) / sqrt(variance);
+    if (result->u < mean)
+        result->z = -result->z;
+    result->p_value = erfc(fabs(result->z) / sqrt(2.0));
+
+    return 0;
+}
@@ -0,0 +1,28 @@
+#ifndef BENCH_STATS_H
+#define BENCH_STATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Samples on each side up to which a test without ties takes p from the exact distribution of U. */
+#define BENCH_STATS_EXACT_MAX_COUNT (50)
+
+/*
+ * Two-sided Mann-Whitney U test of a against b. Small samples without ties use the exact distribution of U,
+ * the others the normal approximation with tie and continuity correction. z is 0 for an exact test.
+ */
+typedef struct mann_whitney_stct
+{
+    double u;
+    double z;
+    double p_value;
+    bool exact;
+} mann_whitney_t;
+
+/* Sorts values in place. */
+double bench_stats_median(double *values, size_t count);
+int bench_stats_mann_whitney(const double *a, size_t a_count, const double *b, size_t b_count, mann_whitney_t *result);
+/* Smallest two-sided p any a_count against b_count runs can give, when every run of one side beats the other. */
+double bench_stats_mann_whitney_min_p_value(size_t a_count, size_t b_count);
+
+#endif
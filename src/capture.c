@@ -0,0 +1,228 @@
+#if defined(__linux__)
+#define _DEFAULT_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <aeronc.h>
+
+#include "capture.h"
+
+int capture_reader_open(capture_reader_t *reader, const char *path)
+{
+    struct stat st;
+    int flags = MAP_PRIVATE;
+
+    memset(reader, 0, sizeof(capture_reader_t));
+    reader->fd = -1;
+
+    if ((reader->fd = open(path, O_RDONLY)) < 0)
+    {
+        fprintf(stderr, "capture_reader_open: %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    if (fstat(reader->fd, &st) < 0)
+    {
+        fprintf(stderr, "capture_reader_open: %s: %s\n", path, strerror(errno));
+        goto error;
+    }
+
+    if ((size_t)st.st_size < CAPTURE_FILE_HEADER_LENGTH)
+    {
+        fprintf(stderr, "capture_reader_open: %s: too short for a capture\n", path);
+        goto error;
+    }
+
+#if defined(MAP_POPULATE)
+    // fault the whole file in now, so replay is not paced by page cache misses
+    flags |= MAP_POPULATE;
+#endif
+
+    reader->mapping_length = (size_t)st.st_size;
+    reader->mapping = mmap(NULL, reader->mapping_length, PROT_READ, flags, reader->fd, 0);
+    if (MAP_FAILED == reader->mapping)
+    {
+        reader->mapping = NULL;
+        fprintf(stderr, "capture_reader_open: mmap %s: %s\n", path, strerror(errno));
+        goto error;
+    }
+    madvise(reader->mapping, reader->mapping_length, MADV_SEQUENTIAL);
+
+    const struct capture_file_header_t *header = (const struct capture_file_header_t *)reader->mapping;
+    if (header->magic != CAPTURE_MAGIC || header->version != CAPTURE_VERSION || header->header_length != CAPTURE_FILE_HEADER_LENGTH)
+    {
+        fprintf(stderr, "capture_reader_open: %s: not a version %d capture\n", path, CAPTURE_VERSION);
+        goto error;
+    }
+
+    // a journal that was not closed cleanly has no data length, its records end at the first zero length
+    reader->data_end = reader->mapping_length;
+    if (header->data_length > 0 && CAPTURE_FILE_HEADER_LENGTH + header->data_length < reader->mapping_length)
+    {
+        reader->data_end = CAPTURE_FILE_HEADER_LENGTH + header->data_length;
+    }
+
+    capture_reader_rewind(reader);
+
+    return 0;
+
+error:
+    capture_reader_close(reader);
+    return -1;
+}
+
+void capture_reader_close(capture_reader_t *reader)
+{
+    if (NULL != reader->mapping)
+    {
+        munmap(reader->mapping, reader->mapping_length);
+        reader->mapping = NULL;
+    }
+
+    if (reader->fd >= 0)
+    {
+        close(reader->fd);
+        reader->fd = -1;
+    }
+}
+
+static int capture_writer_map(capture_writer_t *writer, size_t length)
+{
+    int result;
+
+    // allocate the blocks now, a sparse file would take block allocation faults on the receive path
+    if ((result = posix_fallocate(writer->fd, 0, (off_t)length)) != 0)
+    {
+        fprintf(stderr, "capture_writer: fallocate %zu bytes: %s\n", length, strerror(result));
+        return -1;
+    }
+
+    uint8_t *mapping;
+#if defined(__linux__)
+    if (NULL != writer->mapping)
+    {
+        mapping = mremap(writer->mapping, writer->mapping_length, length, MREMAP_MAYMOVE);
+    }
+    else
+#endif
+    {
+        if (NULL != writer->mapping)
+        {
+            munmap(writer->mapping, writer->mapping_length);
+            writer->mapping = NULL;
+        }
+        mapping = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, writer->fd, 0);
+    }
+
+    if (MAP_FAILED == mapping)
+    {
+        fprintf(stderr, "capture_writer: mapping %zu bytes: %s\n", length, strerror(errno));
+        return -1;
+    }
+
+    writer->mapping = mapping;
+    writer->mapping_length = length;
+
+    return 0;
+}
+
+int capture_writer_open(capture_writer_t *writer, const char *path, size_t segment_length)
+{
+    memset(writer, 0, sizeof(capture_writer_t));
+    writer->fd = -1;
+    writer->segment_length = segment_length;
+
+    if (segment_length < CAPTURE_FILE_HEADER_LENGTH || segment_length % CAPTURE_RECORD_ALIGNMENT != 0)
+    {
+        fprintf(stderr, "capture_writer_open: segment length %zu not a multiple of %d\n", segment_length, CAPTURE_RECORD_ALIGNMENT);
+        return -1;
+    }
+
+    if ((writer->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644)) < 0)
+    {
+        fprintf(stderr, "capture_writer_open: %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    if (capture_writer_map(writer, segment_length) < 0)
+    {
+        close(writer->fd);
+        writer->fd = -1;
+        return -1;
+    }
+
+    struct capture_file_header_t *header = (struct capture_file_header_t *)writer->mapping;
+    header->magic = CAPTURE_MAGIC;
+    header->version = CAPTURE_VERSION;
+    header->header_length = CAPTURE_FILE_HEADER_LENGTH;
+    header->data_length = 0;
+    header->record_count = 0;
+    writer->position = CAPTURE_FILE_HEADER_LENGTH;
+
+    return 0;
+}
+
+int capture_writer_grow(capture_writer_t *writer, size_t min_length)
+{
+    int64_t start_ns = aeron_nano_clock();
+    size_t length = writer->mapping_length;
+
+    while (length < min_length)
+        length += writer->segment_length;
+
+    if (capture_writer_map(writer, length) < 0)
+    {
+        return -1;
+    }
+
+    int64_t duration_ns = aeron_nano_clock() - start_ns;
+    writer->grow_count++;
+    writer->grow_total_ns += duration_ns;
+    if (duration_ns > writer->grow_max_ns)
+        writer->grow_max_ns = duration_ns;
+
+    return 0;
+}
+
+/* Seals the header and trims the preallocated tail, so the file ends with the last record. */
+int capture_writer_close(capture_writer_t *writer)
+{
+    int result = 0;
+
+    if (NULL != writer->mapping)
+    {
+        struct capture_file_header_t *header = (struct capture_file_header_t *)writer->mapping;
+        header->data_length = writer->position - CAPTURE_FILE_HEADER_LENGTH;
+        header->record_count = writer->record_count;
+
+        munmap(writer->mapping, writer->mapping_length);
+        writer->mapping = NULL;
+    }
+
+    if (writer->fd >= 0)
+    {
+        if (ftruncate(writer->fd, (off_t)writer->position) < 0)
+        {
+            fprintf(stderr, "capture_writer_close: truncate: %s\n", strerror(errno));
+            result = -1;
+        }
+        close(writer->fd);
+        writer->fd = -1;
+    }
+
+    return result;
+}
+
+extern size_t capture_record_aligned_length(size_t length);
+extern void capture_reader_rewind(capture_reader_t *reader);
+extern bool capture_reader_next(capture_reader_t *reader, capture_record_t *record);
+extern int capture_writer_append(capture_writer_t *writer, const uint8_t *fragment, size_t length, int64_t timestamp_ns);
@@ -0,0 +1,149 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <concurrent/aeron_atomic.h>
+
+#include "xtypes.h"
+
+#define CAPTURE_MAGIC (UINT64_C(0x3150414342524541)) // "AERBCAP1" little endian
+#define CAPTURE_VERSION (1)
+#define CAPTURE_RECORD_ALIGNMENT (8)
+#define DEFAULT_CAPTURE_SEGMENT_LENGTH (256 * 1024 * 1024)
+
+#if defined(__linux__) || defined(_MSC_VER)
+#pragma pack(push, 1)
+#else
+#pragma pack(1)
+#endif
+
+/*
+ * A capture file is this header followed by records, each a record header and one bench fragment (frame
+ * header and typed messages) padded to CAPTURE_RECORD_ALIGNMENT. Inter-arrival gaps are the differences
+ * between consecutive record timestamps. A zero length record or data_length ends the data.
+ */
+struct capture_file_header_t // 32
+{
+    xuint64 magic;         //  0- 7
+    xuint32 version;       //  8-11
+    xuint32 header_length; // 12-15
+    xuint64 data_length;   // 16-23 bytes of records after the header
+    xuint64 record_count;  // 24-31
+};
+
+struct capture_record_header_t // 16
+{
+    xuint32 length;       //  0- 3 fragment length, without padding
+    xuint32 reserved;     //  4- 7
+    xint64 timestamp_ns;  //  8-15 receive or send time of the fragment
+};
+
+#if defined(__linux__) || defined(_MSC_VER)
+#pragma pack(pop)
+#else
+#pragma pack()
+#endif
+
+#define CAPTURE_FILE_HEADER_LENGTH (sizeof(struct capture_file_header_t))
+#define CAPTURE_RECORD_HEADER_LENGTH (sizeof(struct capture_record_header_t))
+
+typedef struct capture_record_stct
+{
+    const uint8_t *fragment;
+    size_t length;
+    int64_t timestamp_ns;
+} capture_record_t;
+
+/* Read-only mapping of a capture file, records are handed out in place. */
+typedef struct capture_reader_stct
+{
+    int fd;
+    uint8_t *mapping;
+    size_t mapping_length;
+    size_t data_end;
+    size_t position;
+} capture_reader_t;
+
+/*
+ * Appends records to a shared writable mapping of a preallocated file. When a record does not fit, the file
+ * is extended by another segment and remapped; that is the only syscall on the append path.
+ */
+typedef struct capture_writer_stct
+{
+    int fd;
+    uint8_t *mapping;
+    size_t mapping_length;
+    size_t segment_length;
+    size_t position;
+    uint64_t record_count;
+    uint64_t grow_count;
+    int64_t grow_total_ns;
+    int64_t grow_max_ns;
+} capture_writer_t;
+
+int capture_reader_open(capture_reader_t *reader, const char *path);
+void capture_reader_close(capture_reader_t *reader);
+
+int capture_writer_open(capture_writer_t *writer, const char *path, size_t segment_length);
+int capture_writer_grow(capture_writer_t *writer, size_t min_length);
+int capture_writer_close(capture_writer_t *writer);
+
+inline size_t capture_record_aligned_length(size_t length)
+{
+    return (CAPTURE_RECORD_HEADER_LENGTH + length + (CAPTURE_RECORD_ALIGNMENT - 1)) & ~((size_t)CAPTURE_RECORD_ALIGNMENT - 1);
+}
+
+inline void capture_reader_rewind(capture_reader_t *reader)
+{
+    reader->position = CAPTURE_FILE_HEADER_LENGTH;
+}
+
+/* Points record at the next fragment in the mapping, false at the end of the data. */
+inline bool capture_reader_next(capture_reader_t *reader, capture_record_t *record)
+{
+    if (reader->position + CAPTURE_RECORD_HEADER_LENGTH > reader->data_end)
+        return false;
+
+    const struct capture_record_header_t *header = (const struct capture_record_header_t *)(reader->mapping + reader->position);
+    xuint32 length;
+    AERON_GET_VOLATILE(length, header->length);
+    if (length == 0 || reader->position + CAPTURE_RECORD_HEADER_LENGTH + length > reader->data_end)
+        return false;
+
+    record->fragment = reader->mapping + reader->position + CAPTURE_RECORD_HEADER_LENGTH;
+    record->length = length;
+    record->timestamp_ns = header->timestamp_ns;
+    reader->position += capture_record_aligned_length(length);
+
+    return true;
+}
+
+/* Returns -1 only when the file could not be grown. */
+inline int capture_writer_append(capture_writer_t *writer, const uint8_t *fragment, size_t length, int64_t timestamp_ns)
+{
+    size_t aligned_length = capture_record_aligned_length(length);
+
+    if (writer->position + aligned_length > writer->mapping_length &&
+        capture_writer_grow(writer, writer->position + aligned_length) < 0)
+    {
+        return -1;
+    }
+
+    struct capture_record_header_t *header = (struct capture_record_header_t *)(writer->mapping + writer->position);
+    memcpy(writer->mapping + writer->position + CAPTURE_RECORD_HEADER_LENGTH, fragment, length);
+    header->timestamp_ns = timestamp_ns;
+    header->reserved = 0;
+    // the length goes last with a release store, a reader of an unclosed journal stops at the first zero length
+    AERON_PUT_ORDERED(header->length, (xuint32)length);
+
+    writer->position += aligned_length;
+    writer->record_count++;
+
+    return 0;
+}
+
+#endif
@@ -0,0 +1,266 @@
+#if defined(__linux__)
+#define _DEFAULT_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+#include <math.h>
+
+#if !defined(_MSC_VER)
+#include <unistd.h>
+#endif
+
+#include <aeronc.h>
+#include <aeron_alloc.h>
+#include <util/aeron_parse_util.h>
+
+#include "result_set.h"
+#include "bench_stats.h"
+
+const char usage_str[] =
+    "[-h][-v][-A][-a alpha][-t threshold][-n runs] baseline candidate\n"
+    "    -h               help\n"
+    "    -v               show version and exit\n"
+    "    -A               list every compared metric, not only significant changes\n"
+    "    -a alpha         significance level of the two-sided Mann-Whitney U test (default 0.05)\n"
+    "    -t threshold     smallest relative change of the median that counts, 0.05 is 5% (default)\n"
+    "    -n runs          fewest runs on each side for a verdict (default 5)\n"
+    "    baseline and candidate are JSON lines of repeated runs, e.g. results.jsonl of scripts/sweep.sh with\n"
+    "    REPEATS set, or the -J lines of pub and sub. Exits with failure when any metric regressed or had too\n"
+    "    few runs for a verdict at alpha.\n";
+
+typedef struct compare_metric_stct
+{
+    const char *name;
+    bool higher_is_better;
+} compare_metric_t;
+
+/* Matched against the end of a metric path, so latency_p99_ns covers sub.latency_p99_ns and send_latency_p99_ns. */
+static const compare_metric_t compare_metrics[] = {
+    {"msgs_per_sec", true},
+    {"bytes_per_sec", true},
+    {"back_pressure_ratio", false},
+    {"lost", false},
+    {"cpu_cores", false},
+    {"cycles_per_msg", false},
+    {"instructions_per_msg", false},
+    {"misses_per_msg", false},
+    {"latency_p50_ns", false},
+    {"latency_p90_ns", false},
+    {"latency_p99_ns", false},
+    {"latency_p99_9_ns", false},
+    {"latency_p99_99_ns", false},
+};
+
+static const compare_metric_t *compare_find_metric(const char *path)
+{
+    size_t path_length = strlen(path);
+
+    for (size_t i = 0; i < sizeof(compare_metrics) / sizeof(compare_metrics[0]); i++)
+    {
+        size_t name_length = strlen(compare_metrics[i].name);
+        if (path_length < name_length || strcmp(path + path_length - name_length, compare_metrics[i].name) != 0)
+            continue;
+
+        if (path_length == name_length || path[path_length - name_length - 1] == '.' || path[path_length - name_length - 1] == '_')
+            return &compare_metrics[i];
+    }
+
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    int status = EXIT_FAILURE, opt;
+    double alpha = 0.05;
+    double threshold = 0.05;
+    uint64_t min_runs = 5;
+    bool list_all = false;
+
+    result_set_t baseline = {0}, candidate = {0};
+
+    while ((opt = getopt(argc, argv, "hvAa:n:t:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'A':
+        {
+            list_all = true;
+            break;
+        }
+
+        case 'a':
+        {
+            char *end = NULL;
+            alpha = strtod(optarg, &end);
+            if (end == optarg || *end != '\0' || alpha <= 0.0 || alpha >= 1.0)
+            {
+                fprintf(stderr, "malformed significance level %s\n", optarg);
+                exit(status);
+            }
+            break;
+        }
+
+        case 't':
+        {
+            char *end = NULL;
+            threshold = strtod(optarg, &end);
+            if (end == optarg || *end != '\0' || threshold < 0.0)
+            {
+                fprintf(stderr, "malformed threshold %s\n", optarg);
+                exit(status);
+            }
+            break;
+        }
+
+        case 'n':
+        {
+            if (aeron_parse_size64(optarg, &min_runs) < 0 || min_runs == 0)
+            {
+                fprintf(stderr, "malformed number of runs %s: %s\n", optarg, aeron_errmsg());
+                exit(status);
+            }
+            break;
+        }
+
+        case 'v':
+        {
+            printf(
+                "%s <%s> major %d minor %d patch %d git %s\n",
+                argv[0],
+                aeron_version_full(),
+                aeron_version_major(),
+                aeron_version_minor(),
+                aeron_version_patch(),
+                aeron_version_gitsha());
+            exit(EXIT_SUCCESS);
+        }
+
+        case 'h':
+        default:
+            fprintf(stderr, "Usage: %s %s", argv[0], usage_str);
+            exit(status);
+        }
+    }
+
+    if (argc - optind != 2)
+    {
+        fprintf(stderr, "Usage: %s %s", argv[0], usage_str);
+        exit(status);
+    }
+
+    const char *baseline_path = argv[optind], *candidate_path = argv[optind + 1];
+    uint64_t regressions = 0, improvements = 0, unchanged = 0, inconclusive = 0, missing = 0;
+    const char *last_point = NULL;
+    bool warned_min_p_value = false;
+
+    if (result_set_load(&baseline, baseline_path) < 0 || result_set_load(&candidate, candidate_path) < 0)
+    {
+        goto cleanup;
+    }
+
+    printf("Baseline %s: %" PRIu64 " runs, candidate %s: %" PRIu64 " runs\n",
+           baseline_path, baseline.runs, candidate_path, candidate.runs);
+    printf("Mann-Whitney U at alpha %g, changes of the median under %g%% ignored\n", alpha, threshold * 100.0);
+
+    for (size_t i = 0; i < candidate.count; i++)
+    {
+        result_series_t *after = &candidate.series[i];
+        const compare_metric_t *metric = compare_find_metric(after->metric);
+        if (NULL == metric)
+            continue;
+
+        result_series_t *before = (result_series_t *)result_set_find(&baseline, after->point, after->metric);
+        if (NULL == before)
+        {
+            missing++;
+            continue;
+        }
+
+        mann_whitney_t test;
+        if (bench_stats_mann_whitney(before->samples, before->count, after->samples, after->count, &test) < 0)
+        {
+            fprintf(stderr, "bench_stats_mann_whitney: %s\n", aeron_errmsg());
+            goto cleanup;
+        }
+
+        double before_median = bench_stats_median(before->samples, before->count);
+        double after_median = bench_stats_median(after->samples, after->count);
+        double change = before_median != 0.0 ? (after_median - before_median) / fabs(before_median) :
+                        after_median == before_median ? 0.0 : copysign(INFINITY, after_median);
+        bool better = metric->higher_is_better ? change > 0.0 : change < 0.0;
+        const char *verdict;
+
+        // however clear the change, this many runs can not get under alpha
+        double min_p_value = bench_stats_mann_whitney_min_p_value(before->count, after->count);
+        if (min_p_value >= alpha && !warned_min_p_value)
+        {
+            fprintf(stderr, "warning: %zu against %zu runs can not give p below %.4f, alpha %g is out of reach\n",
+                    before->count, after->count, min_p_value, alpha);
+            warned_min_p_value = true;
+        }
+
+        if (before->count < min_runs || after->count < min_runs || min_p_value >= alpha)
+        {
+            verdict = "too few runs";
+            inconclusive++;
+        }
+        else if (test.p_value < alpha && fabs(change) >= threshold)
+        {
+            verdict = better ? "IMPROVEMENT" : "REGRESSION";
+            if (better)
+                improvements++;
+            else
+                regressions++;
+        }
+        else
+        {
+            verdict = "unchanged";
+            unchanged++;
+        }
+
+        if (!list_all && strcmp(verdict, "unchanged") == 0)
+            continue;
+
+        if (NULL == last_point || strcmp(last_point, after->point) != 0)
+        {
+            printf("%s\n", after->point[0] != '\0' ? after->point : "(no point)");
+            last_point = after->point;
+        }
+
+        printf("    %-32s %12.6g -> %12.6g %+8.2f%%  p %.4f  runs %zu/%zu  %s\n",
+               after->metric,
+               before_median,
+               after_median,
+               change * 100.0,
+               test.p_value,
+               before->count,
+               after->count,
+               verdict);
+    }
+
+    printf(
+        "%" PRIu64 " regressions, %" PRIu64 " improvements, %" PRIu64 " unchanged, %" PRIu64 " inconclusive, %" PRIu64
+        " not in the baseline\n",
+        regressions,
+        improvements,
+        unchanged,
+        inconclusive,
+        missing);
+
+    // a metric left undecided is no evidence against a regression
+    if (regressions == 0 && inconclusive == 0)
+    {
+        status = EXIT_SUCCESS;
+    }
+
+cleanup:
+    result_set_close(&baseline);
+    result_set_close(&candidate);
+
+    return status;
+}
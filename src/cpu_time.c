@@ -0,0 +1,20 @@
+#if defined(__linux__)
+#define _DEFAULT_SOURCE
+#endif
+
+#include <sys/resource.h>
+
+#include "cpu_time.h"
+
+int64_t cpu_time_process_ns(void)
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) < 0)
+        return 0;
+
+    return ((int64_t)usage.ru_utime.tv_sec + (int64_t)usage.ru_stime.tv_sec) * INT64_C(1000000000) +
+           ((int64_t)usage.ru_utime.tv_usec + (int64_t)usage.ru_stime.tv_usec) * INT64_C(1000);
+}
+
+extern int64_t cpu_time_thread_ns(void);
+extern double cpu_time_cores(int64_t cpu_ns, int64_t wall_ns);
@@ -0,0 +1,26 @@
+#ifndef CPU_TIME_H
+#define CPU_TIME_H
+
+#include <stdint.h>
+#include <time.h>
+
+/* User plus system CPU time of the calling thread, cheap enough to read at the start and end of a run. */
+inline int64_t cpu_time_thread_ns(void)
+{
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) < 0)
+        return 0;
+
+    return (int64_t)ts.tv_sec * INT64_C(1000000000) + ts.tv_nsec;
+}
+
+/* User plus system CPU time of every thread of the process, the client conductor and any embedded driver included. */
+int64_t cpu_time_process_ns(void);
+
+/* CPU time as a share of one core over wall_ns, 1.0 is a core kept fully busy. */
+inline double cpu_time_cores(int64_t cpu_ns, int64_t wall_ns)
+{
+    return wall_ns > 0 ? (double)cpu_ns / (double)wall_ns : 0.0;
+}
+
+#endif
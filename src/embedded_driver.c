@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <aeronc.h>
+
+#include "embedded_driver.h"
+
+int embedded_driver_parse_threading_mode(const char *str, aeron_threading_mode_t *mode)
+{
+    if (strcmp(str, "dedicated") == 0)
+        *mode = AERON_THREADING_MODE_DEDICATED;
+    else if (strcmp(str, "shared-network") == 0)
+        *mode = AERON_THREADING_MODE_SHARED_NETWORK;
+    else if (strcmp(str, "shared") == 0)
+        *mode = AERON_THREADING_MODE_SHARED;
+    else
+        return -1;
+
+    return 0;
+}
+
+const char *embedded_driver_threading_mode_name(aeron_threading_mode_t mode)
+{
+    switch (mode)
+    {
+    case AERON_THREADING_MODE_DEDICATED:
+        return "dedicated";
+    case AERON_THREADING_MODE_SHARED_NETWORK:
+        return "shared-network";
+    case AERON_THREADING_MODE_SHARED:
+        return "shared";
+    default:
+        return "unknown";
+    }
+}
+
+int embedded_driver_start(
+    embedded_driver_t *driver, const char *aeron_dir, aeron_threading_mode_t mode, const char *idle_strategy)
+{
+    driver->context = NULL;
+    driver->driver = NULL;
+
+    if (aeron_driver_context_init(&driver->context) < 0)
+    {
+        fprintf(stderr, "aeron_driver_context_init: %s\n", aeron_errmsg());
+        goto error;
+    }
+
+    if (NULL != aeron_dir && aeron_driver_context_set_dir(driver->context, aeron_dir) < 0)
+    {
+        fprintf(stderr, "aeron_driver_context_set_dir: %s\n", aeron_errmsg());
+        goto error;
+    }
+
+    // the directory belongs to this process only, leave nothing behind in /dev/shm
+    if (aeron_driver_context_set_dir_delete_on_shutdown(driver->context, true) < 0 ||
+        aeron_driver_context_set_threading_mode(driver->context, mode) < 0)
+    {
+        fprintf(stderr, "aeron_driver_context_set: %s\n", aeron_errmsg());
+        goto error;
+    }
+
+    if (NULL != idle_strategy &&
+        (aeron_driver_context_set_conductor_idle_strategy(driver->context, idle_strategy) < 0 ||
+         aeron_driver_context_set_sender_idle_strategy(driver->context, idle_strategy) < 0 ||
+         aeron_driver_context_set_receiver_idle_strategy(driver->context, idle_strategy) < 0 ||
+         aeron_driver_context_set_sharednetwork_idle_strategy(driver->context, idle_strategy) < 0 ||
+         aeron_driver_context_set_shared_idle_strategy(driver->context, idle_strategy) < 0))
+    {
+        fprintf(stderr, "idle strategy %s: %s\n", idle_strategy, aeron_errmsg());
+        goto error;
+    }
+
+    if (aeron_driver_init(&driver->driver, driver->context) < 0)
+    {
+        fprintf(stderr, "aeron_driver_init: %s\n", aeron_errmsg());
+        goto error;
+    }
+
+    if (aeron_driver_start(driver->driver, false) < 0)
+    {
+        fprintf(stderr, "aeron_driver_start: %s\n", aeron_errmsg());
+        goto error;
+    }
+
+    printf("Embedded media driver in %s threading mode at %s\n",
+           embedded_driver_threading_mode_name(mode), aeron_driver_context_get_dir(driver->context));
+
+    return 0;
+
+error:
+    embedded_driver_close(driver);
+    return -1;
+}
+
+const char *embedded_driver_dir(embedded_driver_t *driver)
+{
+    return aeron_driver_context_get_dir(driver->context);
+}
+
+void embedded_driver_close(embedded_driver_t *driver)
+{
+    if (NULL != driver->driver)
+    {
+        aeron_driver_close(driver->driver);
+        driver->driver = NULL;
+    }
+
+    if (NULL != driver->context)
+    {
+        aeron_driver_context_close(driver->context);
+        driver->context = NULL;
+    }
+}
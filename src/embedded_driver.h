@@ -0,0 +1,28 @@
+#ifndef EMBEDDED_DRIVER_H
+#define EMBEDDED_DRIVER_H
+
+#include <stdbool.h>
+
+#include <aeronmd.h>
+
+/*
+ * In-process C media driver with its own agent threads. Clients of the same process, or any other process
+ * pointed at the same aeron.dir, use it like an external driver.
+ */
+typedef struct embedded_driver_stct
+{
+    aeron_driver_context_t *context;
+    aeron_driver_t *driver;
+} embedded_driver_t;
+
+/* Accepts dedicated, shared-network or shared. */
+int embedded_driver_parse_threading_mode(const char *str, aeron_threading_mode_t *mode);
+const char *embedded_driver_threading_mode_name(aeron_threading_mode_t mode);
+
+/* A NULL aeron_dir or idle_strategy keeps the driver default. */
+int embedded_driver_start(
+    embedded_driver_t *driver, const char *aeron_dir, aeron_threading_mode_t mode, const char *idle_strategy);
+const char *embedded_driver_dir(embedded_driver_t *driver);
+void embedded_driver_close(embedded_driver_t *driver);
+
+#endif
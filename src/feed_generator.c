@@ -0,0 +1,229 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <inttypes.h>
+
+#include <aeronc.h>
+#include <aeron_alloc.h>
+#include <util/aeron_bitutil.h>
+
+#include "feed_generator.h"
+#include "bench_random.h"
+
+#define FEED_GENERATOR_EXPIRATIONS (24)
+
+void feed_generator_config_init(feed_generator_config_t *config)
+{
+    config->length = DEFAULT_FEED_GENERATOR_LENGTH;
+    config->contracts = 1;
+    config->contracts_per_symbol = DEFAULT_FEED_GENERATOR_CONTRACTS_PER_SYMBOL;
+    config->zipf_exponent = DEFAULT_FEED_GENERATOR_ZIPF_EXPONENT;
+    config->quotes_per_trade = DEFAULT_FEED_GENERATOR_QUOTES_PER_TRADE;
+    config->seed = DEFAULT_FEED_GENERATOR_SEED;
+}
+
+int feed_generator_parse_contracts(const char *str, uint64_t *contracts)
+{
+    char *end = NULL;
+    double value = strtod(str, &end);
+
+    if (end == str || value <= 0.0)
+    {
+        return -1;
+    }
+
+    switch (*end)
+    {
+    case 'k':
+    case 'K':
+        value *= 1e3;
+        end++;
+        break;
+    case 'm':
+    case 'M':
+        value *= 1e6;
+        end++;
+        break;
+    case 'g':
+    case 'G':
+        value *= 1e9;
+        end++;
+        break;
+    default:
+        break;
+    }
+
+    if (*end != '\0' || value >= 18446744073709551616.0)
+    {
+        return -1;
+    }
+
+    *contracts = (uint64_t)value;
+
+    return *contracts > 0 ? 0 : -1;
+}
+
+/* Bijective base 26 ticker, A..Z, AA..ZZ and so on, up to five letters. */
+static void feed_generator_symbol(uint64_t symbol, xuint8 *name)
+{
+    memset(name, 0, 5);
+    for (int i = 0; i < 5; i++)
+    {
+        name[i] = (xuint8)('A' + symbol % 26);
+        symbol /= 26;
+        if (symbol-- == 0)
+            break;
+    }
+}
+
+/* Spreads a symbol's contracts over 12 call and 12 put expirations, then over strikes. */
+static void feed_generator_contract(uint64_t contract, xuint8 *expiration, xuint32 *strike_price)
+{
+    uint64_t series = contract % FEED_GENERATOR_EXPIRATIONS;
+
+    expiration[0] = (xuint8)('A' + series); // A-L calls, M-X puts
+    expiration[1] = 26;
+    expiration[2] = (xuint8)(1 + (contract / FEED_GENERATOR_EXPIRATIONS) % 28);
+    *strike_price = (xuint32)(5000 + (contract / FEED_GENERATOR_EXPIRATIONS) * 2500);
+}
+
+static uint64_t feed_generator_zipf_sample(const double *cdf, uint64_t count, double u)
+{
+    uint64_t low = 0, high = count - 1;
+
+    while (low < high)
+    {
+        uint64_t mid = low + (high - low) / 2;
+        if (cdf[mid] < u)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return low;
+}
+
+int feed_generator_init(feed_generator_t *generator, const feed_generator_config_t *config)
+{
+    memset(generator, 0, sizeof(feed_generator_t));
+
+    if (!AERON_IS_POWER_OF_TWO(config->length) || config->length > UINT32_MAX / (1 + sizeof(union option_t)))
+    {
+        fprintf(stderr, "feed_generator_init: length %" PRIu64 " not a power of two or too large\n", config->length);
+        return -1;
+    }
+
+    if (config->contracts == 0 || config->contracts_per_symbol == 0)
+    {
+        fprintf(stderr, "feed_generator_init: no contracts\n");
+        return -1;
+    }
+
+    uint64_t symbols = (config->contracts + config->contracts_per_symbol - 1) / config->contracts_per_symbol;
+    double *cdf = NULL;
+
+    if (aeron_alloc((void **)&cdf, sizeof(double) * symbols) < 0 ||
+        aeron_alloc((void **)&generator->offsets, sizeof(uint32_t) * config->length) < 0 ||
+        aeron_alloc((void **)&generator->arena, (1 + sizeof(union option_t)) * config->length) < 0)
+    {
+        aeron_free(cdf);
+        feed_generator_close(generator);
+        return -1;
+    }
+
+    double total = 0.0;
+    for (uint64_t s = 0; s < symbols; s++)
+    {
+        total += 1.0 / pow((double)(s + 1), config->zipf_exponent);
+        cdf[s] = total;
+    }
+    for (uint64_t s = 0; s < symbols; s++)
+        cdf[s] /= total;
+
+    bench_random_t random;
+    bench_random_init(&random, config->seed);
+
+    size_t offset = 0;
+    for (uint64_t i = 0; i < config->length; i++)
+    {
+        uint64_t symbol = feed_generator_zipf_sample(cdf, symbols, bench_random_double(&random));
+        uint64_t first_contract = symbol * config->contracts_per_symbol;
+        uint64_t symbol_contracts = config->contracts - first_contract < config->contracts_per_symbol ?
+            config->contracts - first_contract : config->contracts_per_symbol;
+        uint64_t contract = bench_random_below(&random, symbol_contracts);
+
+        // a stable mid price per contract, so quotes and trades of one contract stay consistent
+        xuint32 mid_price = (xuint32)(100 + ((first_contract + contract) * UINT64_C(7919)) % 100000);
+        xuint32 half_spread = (xuint32)(1 + bench_random_below(&random, 50));
+        uint8_t *message = generator->arena + offset;
+
+        generator->offsets[i] = (uint32_t)offset;
+        if (bench_random_below(&random, config->quotes_per_trade + 1) == 0)
+        {
+            struct nms_opra_trade_t *trade = (struct nms_opra_trade_t *)(message + 1);
+
+            message[0] = NMS_OPRA_TRADE_TYPE;
+            feed_generator_symbol(symbol, trade->symbol);
+            feed_generator_contract(contract, trade->expiration, &trade->strike_price);
+            trade->timestamp = 0;
+            trade->premium_price = mid_price - half_spread + (xuint32)bench_random_below(&random, 2 * half_spread + 1);
+            trade->volume = (XC_VOLUME)(1 + bench_random_below(&random, 100));
+            trade->exchange = (xuint8)('A' + bench_random_below(&random, 26));
+            trade->condition = 'a';
+            generator->trades++;
+        }
+        else
+        {
+            struct nms_opra_quote_t *quote = (struct nms_opra_quote_t *)(message + 1);
+
+            message[0] = NMS_OPRA_QUOTE_TYPE;
+            feed_generator_symbol(symbol, quote->symbol);
+            feed_generator_contract(contract, quote->expiration, &quote->strike_price);
+            quote->timestamp = 0;
+            quote->bid_price = mid_price - half_spread;
+            quote->ask_price = mid_price + half_spread;
+            quote->bid_size = (XC_VOLUME)(1 + bench_random_below(&random, 500));
+            quote->ask_size = (XC_VOLUME)(1 + bench_random_below(&random, 500));
+            quote->bid_exchange = (xuint8)('A' + bench_random_below(&random, 26));
+            quote->ask_exchange = (xuint8)('A' + bench_random_below(&random, 26));
+            quote->condition = 'a';
+            generator->quotes++;
+        }
+
+        offset += bench_typed_message_length(message[0]);
+    }
+
+    aeron_free(cdf);
+
+    generator->arena_length = offset;
+    generator->length_mask = config->length - 1;
+    generator->symbols = symbols;
+    generator->contracts = config->contracts;
+
+    return 0;
+}
+
+void feed_generator_close(feed_generator_t *generator)
+{
+    aeron_free(generator->arena);
+    aeron_free(generator->offsets);
+    generator->arena = NULL;
+    generator->offsets = NULL;
+}
+
+void feed_generator_print_summary(const feed_generator_t *generator)
+{
+    printf(
+        "Feed arena: %" PRIu64 " messages (%" PRIu64 " trades, %" PRIu64 " quotes), %.04g MB, %" PRIu64
+        " contracts over %" PRIu64 " symbols\n",
+        generator->length_mask + 1,
+        generator->trades,
+        generator->quotes,
+        (double)generator->arena_length / (double)(1024 * 1024),
+        generator->contracts,
+        generator->symbols);
+}
+
+extern const uint8_t *feed_generator_message(const feed_generator_t *generator, uint64_t i);
+extern size_t feed_generator_message_length(const feed_generator_t *generator, uint64_t i);
+extern size_t feed_generator_write(const feed_generator_t *generator, uint64_t i, uint8_t *buffer, int64_t timestamp_ns);
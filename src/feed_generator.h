@@ -0,0 +1,73 @@
+#ifndef FEED_GENERATOR_H
+#define FEED_GENERATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "bench_message.h"
+
+#define DEFAULT_FEED_GENERATOR_LENGTH (1024 * 1024)
+#define DEFAULT_FEED_GENERATOR_CONTRACTS_PER_SYMBOL (300)
+#define DEFAULT_FEED_GENERATOR_ZIPF_EXPONENT (1.0)
+#define DEFAULT_FEED_GENERATOR_QUOTES_PER_TRADE (1)
+#define DEFAULT_FEED_GENERATOR_SEED (42)
+
+typedef struct feed_generator_config_stct
+{
+    uint64_t length;
+    uint64_t contracts;
+    uint64_t contracts_per_symbol;
+    double zipf_exponent;
+    uint64_t quotes_per_trade;
+    uint64_t seed;
+} feed_generator_config_t;
+
+/*
+ * Arena of typed messages (type byte + packed struct) generated up front, so publishing a message is one
+ * copy out of memory plus a timestamp. Symbols are drawn with Zipf popularity, contracts uniformly within
+ * the symbol, and each message is a trade with probability 1 / (quotes_per_trade + 1).
+ * The arena repeats after length messages, length is a power of two.
+ */
+typedef struct feed_generator_stct
+{
+    uint8_t *arena;
+    size_t arena_length;
+    uint32_t *offsets;
+    uint64_t length_mask;
+    uint64_t symbols;
+    uint64_t contracts;
+    uint64_t trades;
+    uint64_t quotes;
+} feed_generator_t;
+
+void feed_generator_config_init(feed_generator_config_t *config);
+/* Accepts a contract count such as 250000, 250k or 1.5M. Suffixes are decimal. */
+int feed_generator_parse_contracts(const char *str, uint64_t *contracts);
+int feed_generator_init(feed_generator_t *generator, const feed_generator_config_t *config);
+void feed_generator_close(feed_generator_t *generator);
+void feed_generator_print_summary(const feed_generator_t *generator);
+
+inline const uint8_t *feed_generator_message(const feed_generator_t *generator, uint64_t i)
+{
+    return generator->arena + generator->offsets[i & generator->length_mask];
+}
+
+inline size_t feed_generator_message_length(const feed_generator_t *generator, uint64_t i)
+{
+    return bench_typed_message_length(feed_generator_message(generator, i)[0]);
+}
+
+/* Copies message i into buffer and stamps it, returns the typed message length. */
+inline size_t feed_generator_write(const feed_generator_t *generator, uint64_t i, uint8_t *buffer, int64_t timestamp_ns)
+{
+    const uint8_t *message = feed_generator_message(generator, i);
+    size_t length = bench_typed_message_length(message[0]);
+
+    memcpy(buffer, message, length);
+    ((struct nms_opra_trade_t *)(buffer + 1))->timestamp = (XC_HITIME)timestamp_ns;
+
+    return length;
+}
+
+#endif
@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <aeronc.h>
+#include <aeron_alloc.h>
+
+#include "histogram.h"
+
+int histogram_init(histogram_t *histogram, int64_t highest_trackable_value, int32_t significant_figures)
+{
+    if (significant_figures < 1 || significant_figures > 5 || highest_trackable_value < 2)
+    {
+        fprintf(stderr, "histogram_init: invalid range %" PRId64 " or precision %" PRId32 "\n",
+                highest_trackable_value, significant_figures);
+        return -1;
+    }
+
+    /* smallest power of two sub-bucket count that resolves 2 * 10^significant_figures distinct values */
+    int64_t largest_value_with_single_unit_resolution = 2;
+    for (int32_t i = 0; i < significant_figures; i++)
+        largest_value_with_single_unit_resolution *= 10;
+
+    int32_t sub_bucket_count_magnitude = 0;
+    while ((INT64_C(1) << sub_bucket_count_magnitude) < largest_value_with_single_unit_resolution)
+        sub_bucket_count_magnitude++;
+
+    int64_t sub_bucket_count = INT64_C(1) << sub_bucket_count_magnitude;
+    int64_t smallest_untrackable_value = sub_bucket_count;
+    int32_t bucket_count = 1;
+    while (smallest_untrackable_value <= highest_trackable_value)
+    {
+        if (smallest_untrackable_value > INT64_MAX / 2)
+        {
+            bucket_count++;
+            break;
+        }
+        smallest_untrackable_value <<= 1;
+        bucket_count++;
+    }
+
+    histogram->highest_trackable_value = highest_trackable_value;
+    histogram->sub_bucket_half_count_magnitude = sub_bucket_count_magnitude - 1;
+    histogram->sub_bucket_half_count = (int32_t)(sub_bucket_count / 2);
+    histogram->sub_bucket_mask = sub_bucket_count - 1;
+    histogram->counts_length = (bucket_count + 1) * histogram->sub_bucket_half_count;
+    histogram->counts = NULL;
+
+    if (aeron_alloc((void **)&histogram->counts, sizeof(uint64_t) * histogram->counts_length) < 0)
+    {
+        return -1;
+    }
+
+    histogram_reset(histogram);
+
+    return 0;
+}
+
+void histogram_close(histogram_t *histogram)
+{
+    aeron_free(histogram->counts);
+    histogram->counts = NULL;
+}
+
+void histogram_reset(histogram_t *histogram)
+{
+    memset(histogram->counts, 0, sizeof(uint64_t) * histogram->counts_length);
+    histogram->total_count = 0;
+    histogram->min_value = INT64_MAX;
+    histogram->max_value = 0;
+    histogram->sum = 0;
+}
+
+void histogram_add(histogram_t *to, const histogram_t *from)
+{
+    if (to->counts_length != from->counts_length)
+    {
+        fprintf(stderr, "histogram_add: histograms have different layouts\n");
+        return;
+    }
+
+    for (int32_t i = 0; i < from->counts_length; i++)
+        to->counts[i] += from->counts[i];
+
+    to->total_count += from->total_count;
+    to->sum += from->sum;
+    if (from->min_value < to->min_value)
+        to->min_value = from->min_value;
+    if (from->max_value > to->max_value)
+        to->max_value = from->max_value;
+}
+
+static int64_t histogram_highest_equivalent_value_at(const histogram_t *histogram, int32_t index)
+{
+    int32_t bucket_index = (index >> histogram->sub_bucket_half_count_magnitude) - 1;
+    int64_t sub_bucket_index = (index & (histogram->sub_bucket_half_count - 1)) + histogram->sub_bucket_half_count;
+
+    if (bucket_index < 0)
+    {
+        sub_bucket_index -= histogram->sub_bucket_half_count;
+        bucket_index = 0;
+    }
+
+    return (sub_bucket_index << bucket_index) + (INT64_C(1) << bucket_index) - 1;
+}
+
+int64_t histogram_value_at_percentile(const histogram_t *histogram, double percentile)
+{
+    if (histogram->total_count == 0)
+        return 0;
+
+    if (percentile > 100.0)
+        percentile = 100.0;
+
+    int64_t count_at_percentile = (int64_t)((percentile / 100.0) * (double)histogram->total_count + 0.5);
+    if (count_at_percentile < 1)
+        count_at_percentile = 1;
+
+    int64_t total = 0;
+    for (int32_t i = 0; i < histogram->counts_length; i++)
+    {
+        total += (int64_t)histogram->counts[i];
+        if (total >= count_at_percentile)
+        {
+            int64_t value = histogram_highest_equivalent_value_at(histogram, i);
+            return value < histogram->max_value ? value : histogram->max_value;
+        }
+    }
+
+    return histogram->max_value;
+}
+
+double histogram_mean(const histogram_t *histogram)
+{
+    return histogram->total_count > 0 ? (double)histogram->sum / (double)histogram->total_count : 0.0;
+}
+
+void print_latency_report(const char *label, const histogram_t *histogram)
+{
+    printf("%s latency (us): count %" PRId64 " min %.3f mean %.3f p50 %.3f p99 %.3f p99.9 %.3f p99.99 %.3f max %.3f\n",
+           label,
+           histogram->total_count,
+           histogram->total_count > 0 ? (double)histogram->min_value / 1000.0 : 0.0,
+           histogram_mean(histogram) / 1000.0,
+           (double)histogram_value_at_percentile(histogram, 50.0) / 1000.0,
+           (double)histogram_value_at_percentile(histogram, 99.0) / 1000.0,
+           (double)histogram_value_at_percentile(histogram, 99.9) / 1000.0,
+           (double)histogram_value_at_percentile(histogram, 99.99) / 1000.0,
+           (double)histogram->max_value / 1000.0);
+}
+
+extern int32_t histogram_counts_index(const histogram_t *histogram, int64_t value);
+extern void histogram_record_value(histogram_t *histogram, int64_t value);
@@ -0,0 +1,67 @@
+#ifndef AERON_BENCH_HISTOGRAM_H
+#define AERON_BENCH_HISTOGRAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define DEFAULT_HISTOGRAM_HIGHEST_TRACKABLE_VALUE (INT64_C(60) * 1000 * 1000 * 1000) /* 60s in ns */
+#define DEFAULT_HISTOGRAM_SIGNIFICANT_FIGURES (3)
+
+/*
+ * Log-linear histogram in the style of HdrHistogram: values are bucketed by their power of two and each
+ * bucket is split into a fixed number of linear sub-buckets, giving a constant relative precision over
+ * the whole range. Recording is a couple of shifts and an increment, so it can be used on the hot path.
+ * Not thread safe, one writer per histogram.
+ */
+typedef struct histogram_stct
+{
+    int64_t highest_trackable_value;
+    int32_t sub_bucket_half_count_magnitude;
+    int32_t sub_bucket_half_count;
+    int64_t sub_bucket_mask;
+    int32_t counts_length;
+
+    int64_t total_count;
+    int64_t min_value;
+    int64_t max_value;
+    int64_t sum;
+    uint64_t *counts;
+} histogram_t;
+
+int histogram_init(histogram_t *histogram, int64_t highest_trackable_value, int32_t significant_figures);
+void histogram_close(histogram_t *histogram);
+void histogram_reset(histogram_t *histogram);
+void histogram_add(histogram_t *to, const histogram_t *from);
+
+int64_t histogram_value_at_percentile(const histogram_t *histogram, double percentile);
+double histogram_mean(const histogram_t *histogram);
+
+void print_latency_report(const char *label, const histogram_t *histogram);
+
+inline int32_t histogram_counts_index(const histogram_t *histogram, int64_t value)
+{
+    int32_t pow2_ceiling = 64 - __builtin_clzll((uint64_t)(value | histogram->sub_bucket_mask));
+    int32_t bucket_index = pow2_ceiling - (histogram->sub_bucket_half_count_magnitude + 1);
+    int32_t sub_bucket_index = (int32_t)(value >> bucket_index);
+
+    return ((bucket_index + 1) << histogram->sub_bucket_half_count_magnitude) +
+           (sub_bucket_index - histogram->sub_bucket_half_count);
+}
+
+inline void histogram_record_value(histogram_t *histogram, int64_t value)
+{
+    if (value < 0)
+        value = 0;
+    else if (value > histogram->highest_trackable_value)
+        value = histogram->highest_trackable_value;
+
+    histogram->counts[histogram_counts_index(histogram, value)]++;
+    histogram->total_count++;
+    histogram->sum += value;
+    if (value < histogram->min_value)
+        histogram->min_value = value;
+    if (value > histogram->max_value)
+        histogram->max_value = value;
+}
+
+#endif // AERON_BENCH_HISTOGRAM_H
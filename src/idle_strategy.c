@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <aeronc.h>
+#include <aeron_agent.h>
+#include <aeron_alloc.h>
+#include <util/aeron_parse_util.h>
+
+#include "idle_strategy.h"
+
+int idle_strategy_init(idle_strategy_t *strategy, const char *spec)
+{
+    memset(strategy, 0, sizeof(idle_strategy_t));
+    snprintf(strategy->name, sizeof(strategy->name), "%s", spec);
+
+    if (strcmp(spec, "busy-spin") == 0 || strcmp(spec, "busy_spin") == 0)
+    {
+        strategy->idle = aeron_idle_strategy_busy_spinning_idle;
+    }
+    else if (strcmp(spec, "noop") == 0)
+    {
+        strategy->idle = aeron_idle_strategy_noop_idle;
+    }
+    else if (strcmp(spec, "yield") == 0)
+    {
+        strategy->idle = aeron_idle_strategy_yielding_idle;
+    }
+    else if (strcmp(spec, "backoff") == 0)
+    {
+        // the client library owns the backoff defaults and allocates its state
+        if ((strategy->idle = aeron_idle_strategy_load("backoff", &strategy->allocated_state, NULL, NULL)) == NULL)
+        {
+            fprintf(stderr, "idle_strategy_init: backoff: %s\n", aeron_errmsg());
+            return -1;
+        }
+        strategy->state = strategy->allocated_state;
+    }
+    else if (strncmp(spec, "sleeping", 8) == 0 && (spec[8] == '\0' || spec[8] == ':'))
+    {
+        strategy->sleep_duration_ns = IDLE_STRATEGY_DEFAULT_SLEEP_NS;
+        if (spec[8] == ':' && (aeron_parse_duration_ns(spec + 9, &strategy->sleep_duration_ns) < 0 || strategy->sleep_duration_ns == 0))
+        {
+            fprintf(stderr, "idle_strategy_init: malformed sleep duration %s\n", spec + 9);
+            return -1;
+        }
+        strategy->idle = aeron_idle_strategy_sleeping_idle;
+        strategy->state = &strategy->sleep_duration_ns;
+    }
+    else
+    {
+        fprintf(stderr, "idle_strategy_init: unknown idle strategy %s, expected busy-spin, noop, yield, backoff or sleeping[:duration]\n", spec);
+        return -1;
+    }
+
+    return 0;
+}
+
+void idle_strategy_close(idle_strategy_t *strategy)
+{
+    aeron_free(strategy->allocated_state);
+    strategy->allocated_state = NULL;
+    strategy->state = NULL;
+}
+
+extern void idle_strategy_idle(idle_strategy_t *strategy, int work_count);
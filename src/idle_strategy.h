@@ -0,0 +1,33 @@
+#ifndef IDLE_STRATEGY_H
+#define IDLE_STRATEGY_H
+
+#include <stdint.h>
+
+#include <aeronc.h>
+
+#define IDLE_STRATEGY_DEFAULT_SLEEP_NS (UINT64_C(100) * 1000) /* 100us */
+
+/*
+ * What a publisher does when back pressured and a subscriber when a poll finds nothing: busy-spin, noop,
+ * yield, backoff (spin, then yield, then park with growing periods) or sleeping[:duration].
+ * The state may point into the struct, so it must not be moved after init.
+ */
+typedef struct idle_strategy_stct
+{
+    aeron_idle_strategy_func_t idle;
+    void *state;
+    void *allocated_state;
+    uint64_t sleep_duration_ns;
+    char name[32];
+} idle_strategy_t;
+
+int idle_strategy_init(idle_strategy_t *strategy, const char *spec);
+void idle_strategy_close(idle_strategy_t *strategy);
+
+/* work_count > 0 resets a backoff, 0 idles once. */
+inline void idle_strategy_idle(idle_strategy_t *strategy, int work_count)
+{
+    strategy->idle(strategy->state, work_count);
+}
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef BENCH_INSTRUMENTATION_H
+#define BENCH_INSTRUMENTATION_H
+
+/*
+ * How the hot paths keep the progress totals the rate reporter and the exported counters read, chosen at
+ * compile time with make INSTRUMENTATION=n:
+ *
+ *   0 none     the updates compile to nothing, -P and -K are ignored
+ *   1 batched  single-writer totals in plain stores, published with an ordered store every
+ *              BENCH_INSTRUMENTATION_BATCH updates and whenever the writer waits (default)
+ *   2 ordered  an ordered store of every total on every update, kept to measure the batching against
+ *
+ * scripts/instrumentation_cost.sh builds all three and compares them over the same sweep.
+ */
+#define BENCH_INSTRUMENTATION_NONE (0)
+#define BENCH_INSTRUMENTATION_BATCHED (1)
+#define BENCH_INSTRUMENTATION_ORDERED (2)
+
+#ifndef BENCH_INSTRUMENTATION
+#define BENCH_INSTRUMENTATION BENCH_INSTRUMENTATION_BATCHED
+#endif
+
+#if BENCH_INSTRUMENTATION == BENCH_INSTRUMENTATION_NONE
+#define BENCH_INSTRUMENTATION_NAME "none"
+#elif BENCH_INSTRUMENTATION == BENCH_INSTRUMENTATION_BATCHED
+#define BENCH_INSTRUMENTATION_NAME "batched"
+#elif BENCH_INSTRUMENTATION == BENCH_INSTRUMENTATION_ORDERED
+#define BENCH_INSTRUMENTATION_NAME "ordered"
+#else
+#error "BENCH_INSTRUMENTATION must be 0, 1 or 2"
+#endif
+
+/* Updates between publishes of the batched totals, a writer that is waiting publishes what it has straight away. */
+#define BENCH_INSTRUMENTATION_BATCH (64)
+
+#endif
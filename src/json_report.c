@@ -0,0 +1,156 @@
+#include <inttypes.h>
+#include <math.h>
+
+#include "json_report.h"
+
+static void json_report_key(json_report_t *report, const char *key)
+{
+    fprintf(report->out, "%s\"%s\":", report->first ? "" : ",", key);
+    report->first = false;
+}
+
+void json_report_begin(json_report_t *report, FILE *out, const char *role)
+{
+    report->out = out;
+    report->first = true;
+    fputc('{', out);
+    json_report_string(report, "role", role);
+}
+
+void json_report_string(json_report_t *report, const char *key, const char *value)
+{
+    json_report_key(report, key);
+    fputc('"', report->out);
+    for (const char *c = value; *c != '\0'; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            fputc('\\', report->out);
+        fputc(*c, report->out);
+    }
+    fputc('"', report->out);
+}
+
+void json_report_uint(json_report_t *report, const char *key, uint64_t value)
+{
+    json_report_key(report, key);
+    fprintf(report->out, "%" PRIu64, value);
+}
+
+void json_report_int(json_report_t *report, const char *key, int64_t value)
+{
+    json_report_key(report, key);
+    fprintf(report->out, "%" PRId64, value);
+}
+
+void json_report_double(json_report_t *report, const char *key, double value)
+{
+    json_report_key(report, key);
+    // JSON has no NaN or infinity, a ratio over zero messages is reported as null
+    if (isfinite(value))
+        fprintf(report->out, "%.6g", value);
+    else
+        fputs("null", report->out);
+}
+
+void json_report_histogram(json_report_t *report, const char *prefix, const histogram_t *histogram)
+{
+    static const struct
+    {
+        const char *suffix;
+        double percentile;
+    } percentiles[] = {
+        {"p50_ns", 50.0},
+        {"p90_ns", 90.0},
+        {"p99_ns", 99.0},
+        {"p99_9_ns", 99.9},
+        {"p99_99_ns", 99.99},
+    };
+    char key[128];
+
+    snprintf(key, sizeof(key), "%s_count", prefix);
+    json_report_uint(report, key, (uint64_t)histogram->total_count);
+    snprintf(key, sizeof(key), "%s_min_ns", prefix);
+    json_report_int(report, key, histogram->total_count > 0 ? histogram->min_value : 0);
+    snprintf(key, sizeof(key), "%s_mean_ns", prefix);
+    json_report_double(report, key, histogram_mean(histogram));
+
+    for (size_t i = 0; i < sizeof(percentiles) / sizeof(percentiles[0]); i++)
+    {
+        snprintf(key, sizeof(key), "%s_%s", prefix, percentiles[i].suffix);
+        json_report_int(report, key, histogram_value_at_percentile(histogram, percentiles[i].percentile));
+    }
+
+    snprintf(key, sizeof(key), "%s_max_ns", prefix);
+    json_report_int(report, key, histogram->max_value);
+}
+
+void json_report_perf_counters(json_report_t *report, const char *prefix, const perf_counter_values_t *values, uint64_t messages)
+{
+    char key[128];
+
+    for (int i = 0; i < PERF_COUNTER_KIND_COUNT; i++)
+    {
+        if (0 == (values->available & (UINT32_C(1) << i)))
+            continue;
+
+        if (PERF_COUNTER_CONTEXT_SWITCHES == i)
+        {
+            snprintf(key, sizeof(key), "%s_%s", prefix, perf_counter_kind_name((perf_counter_kind_t)i));
+            json_report_uint(report, key, values->values[i]);
+        }
+        else
+        {
+            snprintf(key, sizeof(key), "%s_%s_per_msg", prefix, perf_counter_kind_name((perf_counter_kind_t)i));
+            json_report_double(report, key, perf_counter_values_per_message(values, (perf_counter_kind_t)i, messages));
+        }
+    }
+
+    if (values->values[PERF_COUNTER_CYCLES] > 0 && 0 != (values->available & (UINT32_C(1) << PERF_COUNTER_INSTRUCTIONS)))
+    {
+        snprintf(key, sizeof(key), "%s_ipc", prefix);
+        json_report_double(report, key, (double)values->values[PERF_COUNTER_INSTRUCTIONS] / (double)values->values[PERF_COUNTER_CYCLES]);
+    }
+}
+
+static void json_report_lag(json_report_t *report, const char *prefix, const histogram_t *histogram)
+{
+    char key[128];
+
+    snprintf(key, sizeof(key), "%s_p50_bytes", prefix);
+    json_report_int(report, key, histogram_value_at_percentile(histogram, 50.0));
+    snprintf(key, sizeof(key), "%s_p99_bytes", prefix);
+    json_report_int(report, key, histogram_value_at_percentile(histogram, 99.0));
+    snprintf(key, sizeof(key), "%s_max_bytes", prefix);
+    json_report_int(report, key, histogram->max_value);
+}
+
+void json_report_back_pressure(json_report_t *report, const back_pressure_stats_t *stats)
+{
+    char key[128];
+
+    for (int i = 0; i < BACK_PRESSURE_REASON_COUNT; i++)
+    {
+        snprintf(key, sizeof(key), "back_pressure_%s", back_pressure_reason_name((back_pressure_reason_t)i));
+        json_report_uint(report, key, stats->attempts[i]);
+    }
+
+    if (!stats->record_stalls)
+        return;
+
+    for (int i = 0; i < BACK_PRESSURE_REASON_COUNT; i++)
+    {
+        if (stats->stall_histograms[i].total_count == 0)
+            continue;
+        snprintf(key, sizeof(key), "stall_%s", back_pressure_reason_name((back_pressure_reason_t)i));
+        json_report_histogram(report, key, &stats->stall_histograms[i]);
+    }
+    json_report_int(report, "position_window_bytes", stats->window_length);
+    json_report_lag(report, "position_lag", &stats->lag_histogram);
+    json_report_lag(report, "stall_position_lag", &stats->stall_lag_histogram);
+}
+
+void json_report_end(json_report_t *report)
+{
+    fputs("}\n", report->out);
+    fflush(report->out);
+}
@@ -0,0 +1,32 @@
+#ifndef JSON_REPORT_H
+#define JSON_REPORT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "histogram.h"
+#include "perf_counters.h"
+#include "back_pressure.h"
+
+/* Writes one flat JSON object per run on a single line, for sweep scripts to pick out of stdout. */
+typedef struct json_report_stct
+{
+    FILE *out;
+    bool first;
+} json_report_t;
+
+void json_report_begin(json_report_t *report, FILE *out, const char *role);
+void json_report_string(json_report_t *report, const char *key, const char *value);
+void json_report_uint(json_report_t *report, const char *key, uint64_t value);
+void json_report_int(json_report_t *report, const char *key, int64_t value);
+void json_report_double(json_report_t *report, const char *key, double value);
+/* Count, min, mean, max and percentiles in nanoseconds, keys prefixed with prefix. */
+void json_report_histogram(json_report_t *report, const char *prefix, const histogram_t *histogram);
+/* Available perf counters per message, context switches as a count and IPC, keys prefixed with prefix. */
+void json_report_perf_counters(json_report_t *report, const char *prefix, const perf_counter_values_t *values, uint64_t messages);
+/* Failed attempts per reason, with recorded stalls their durations and the position lag in bytes. */
+void json_report_back_pressure(json_report_t *report, const back_pressure_stats_t *stats);
+void json_report_end(json_report_t *report);
+
+#endif
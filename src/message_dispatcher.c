@@ -0,0 +1,39 @@
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "message_dispatcher.h"
+
+void message_dispatcher_init(message_dispatcher_t *dispatcher, void *clientd)
+{
+    memset(dispatcher, 0, sizeof(message_dispatcher_t));
+    dispatcher->clientd = clientd;
+
+    // known types are counted and skipped even without a handler
+    dispatcher->lengths[NMS_OPRA_TRADE_TYPE] = (uint8_t)bench_typed_message_length(NMS_OPRA_TRADE_TYPE);
+    dispatcher->lengths[NMS_OPRA_QUOTE_TYPE] = (uint8_t)bench_typed_message_length(NMS_OPRA_QUOTE_TYPE);
+}
+
+void message_dispatcher_register(message_dispatcher_t *dispatcher, uint8_t type, message_handler_t handler)
+{
+    dispatcher->handlers[type] = handler;
+}
+
+void message_dispatcher_reset_counts(message_dispatcher_t *dispatcher)
+{
+    memset(dispatcher->counts, 0, sizeof(dispatcher->counts));
+}
+
+void message_dispatcher_print_report(const message_dispatcher_t *dispatcher)
+{
+    for (int type = 0; type < MESSAGE_DISPATCHER_TYPE_COUNT; type++)
+    {
+        if (dispatcher->counts[type] > 0)
+        {
+            printf("Type '%c': %" PRIu64 " messages\n", type, dispatcher->counts[type]);
+        }
+    }
+}
+
+extern int64_t message_dispatcher_on_messages(
+    message_dispatcher_t *dispatcher, const uint8_t *buffer, size_t length, uint64_t count);
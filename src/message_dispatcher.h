@@ -0,0 +1,67 @@
+#ifndef MESSAGE_DISPATCHER_H
+#define MESSAGE_DISPATCHER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bench_message.h"
+
+#define MESSAGE_DISPATCHER_TYPE_COUNT (256)
+
+/* Called with the packed struct following the type byte, still in place in the term buffer. */
+typedef void (*message_handler_t)(void *clientd, const uint8_t *body);
+
+/*
+ * Table indexed by the type byte, so dispatching a typed message is one load for its length and one
+ * indirect call, with no copy of the message out of the fragment.
+ */
+typedef struct message_dispatcher_stct
+{
+    void *clientd;
+    message_handler_t handlers[MESSAGE_DISPATCHER_TYPE_COUNT];
+    uint8_t lengths[MESSAGE_DISPATCHER_TYPE_COUNT];
+    uint64_t counts[MESSAGE_DISPATCHER_TYPE_COUNT];
+} message_dispatcher_t;
+
+void message_dispatcher_init(message_dispatcher_t *dispatcher, void *clientd);
+void message_dispatcher_register(message_dispatcher_t *dispatcher, uint8_t type, message_handler_t handler);
+void message_dispatcher_reset_counts(message_dispatcher_t *dispatcher);
+void message_dispatcher_print_report(const message_dispatcher_t *dispatcher);
+
+/*
+ * Dispatches the first count typed messages in buffer, anything after them is frame padding. Returns count,
+ * or -1 when a message has an unknown type or runs past the end of the buffer. Messages before the malformed
+ * one are still dispatched.
+ */
+inline int64_t message_dispatcher_on_messages(
+    message_dispatcher_t *dispatcher, const uint8_t *buffer, size_t length, uint64_t count)
+{
+    size_t offset = 0;
+
+    for (uint64_t i = 0; i < count; i++)
+    {
+        if (offset >= length)
+        {
+            return -1;
+        }
+
+        uint8_t type = buffer[offset];
+        size_t message_length = dispatcher->lengths[type];
+        if (message_length == 0 || offset + message_length > length)
+        {
+            return -1;
+        }
+
+        dispatcher->counts[type]++;
+        if (NULL != dispatcher->handlers[type])
+        {
+            dispatcher->handlers[type](dispatcher->clientd, buffer + offset + 1);
+        }
+
+        offset += message_length;
+    }
+
+    return (int64_t)count;
+}
+
+#endif
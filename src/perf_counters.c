@@ -0,0 +1,277 @@
+#if defined(__linux__)
+#define _DEFAULT_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include <aeronc.h>
+#include <concurrent/aeron_atomic.h>
+
+#include "perf_counters.h"
+
+static const char *perf_counter_kind_names[PERF_COUNTER_KIND_COUNT] = {
+    "cycles",
+    "instructions",
+    "l1d_misses",
+    "llc_misses",
+    "branch_misses",
+    "context_switches",
+};
+
+const char *perf_counter_kind_name(perf_counter_kind_t kind)
+{
+    return kind < PERF_COUNTER_KIND_COUNT ? perf_counter_kind_names[kind] : "unknown";
+}
+
+#if defined(__linux__)
+
+#define PERF_COUNTERS_CACHE_READ_MISS(cache) \
+    ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static const struct
+{
+    uint32_t type;
+    uint64_t config;
+} perf_counter_events[PERF_COUNTER_KIND_COUNT] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, PERF_COUNTERS_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D)},
+    {PERF_TYPE_HW_CACHE, PERF_COUNTERS_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_LL)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+};
+
+static int perf_counters_open_event(perf_counter_kind_t kind, int group_fd, bool user_only)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = perf_counter_events[kind].type;
+    attr.config = perf_counter_events[kind].config;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // the leader holds the whole group back until every member is in
+    attr.disabled = group_fd < 0 ? 1 : 0;
+    attr.exclude_kernel = user_only ? 1 : 0;
+    attr.exclude_hv = 1;
+
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC);
+}
+
+int perf_counters_open(perf_counters_t *counters)
+{
+    int slot = 0;
+
+    memset(counters, 0, sizeof(perf_counters_t));
+    counters->group_fd = -1;
+    for (int i = 0; i < PERF_COUNTER_KIND_COUNT; i++)
+    {
+        counters->fds[i] = -1;
+        counters->slots[i] = -1;
+    }
+
+    for (int i = 0; i < PERF_COUNTER_KIND_COUNT; i++)
+    {
+        int fd = perf_counters_open_event((perf_counter_kind_t)i, counters->group_fd, counters->user_only);
+
+        // with perf_event_paranoid at 2 only user space may be counted, the whole group then counts user space
+        if (fd < 0 && (errno == EACCES || errno == EPERM) && !counters->user_only && counters->group_fd < 0)
+        {
+            counters->user_only = true;
+            fd = perf_counters_open_event((perf_counter_kind_t)i, counters->group_fd, counters->user_only);
+        }
+
+        if (fd < 0)
+        {
+            fprintf(stderr, "perf_counters_open: %s unavailable: %s\n", perf_counter_kind_names[i], strerror(errno));
+            continue;
+        }
+
+        if (counters->group_fd < 0)
+            counters->group_fd = fd;
+        counters->fds[i] = fd;
+        counters->slots[i] = slot++;
+        counters->available |= UINT32_C(1) << i;
+    }
+
+    if (counters->group_fd < 0)
+    {
+        fprintf(stderr, "perf_counters_open: no counters, see /proc/sys/kernel/perf_event_paranoid\n");
+        return -1;
+    }
+
+    if (counters->user_only)
+        fprintf(stderr, "perf_counters_open: counting user space only, perf_event_paranoid is above 1\n");
+
+    ioctl(counters->group_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    if (ioctl(counters->group_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) < 0)
+    {
+        fprintf(stderr, "perf_counters_open: enable: %s\n", strerror(errno));
+        perf_counters_close(counters);
+        return -1;
+    }
+
+    AERON_PUT_ORDERED(counters->ready, true);
+
+    return 0;
+}
+
+/* Safe on zeroed counters that were never opened, only the fds of available kinds are closed. */
+void perf_counters_close(perf_counters_t *counters)
+{
+    AERON_PUT_ORDERED(counters->ready, false);
+    for (int i = 0; i < PERF_COUNTER_KIND_COUNT; i++)
+    {
+        if (0 != (counters->available & (UINT32_C(1) << i)) && counters->fds[i] >= 0)
+        {
+            close(counters->fds[i]);
+            counters->fds[i] = -1;
+        }
+    }
+    counters->group_fd = -1;
+    counters->available = 0;
+}
+
+int perf_counters_read(const perf_counters_t *counters, perf_counter_values_t *values)
+{
+    struct
+    {
+        uint64_t nr;
+        uint64_t time_enabled;
+        uint64_t time_running;
+        uint64_t values[PERF_COUNTER_KIND_COUNT];
+    } group;
+    bool ready;
+
+    memset(values, 0, sizeof(perf_counter_values_t));
+    AERON_GET_VOLATILE(ready, counters->ready);
+    if (!ready)
+        return -1;
+
+    if (read(counters->group_fd, &group, sizeof(group)) < (ssize_t)(3 * sizeof(uint64_t)))
+        return -1;
+
+    // the kernel time slices groups when there are more events than hardware counters
+    double scale = 0.0;
+    if (group.time_running > 0)
+        scale = (double)group.time_enabled / (double)group.time_running;
+
+    for (int i = 0; i < PERF_COUNTER_KIND_COUNT; i++)
+    {
+        if (counters->slots[i] >= 0 && (uint64_t)counters->slots[i] < group.nr)
+            values->values[i] = (uint64_t)((double)group.values[counters->slots[i]] * scale);
+    }
+    values->available = counters->available;
+
+    return 0;
+}
+
+#else
+
+int perf_counters_open(perf_counters_t *counters)
+{
+    memset(counters, 0, sizeof(perf_counters_t));
+    counters->group_fd = -1;
+    for (int i = 0; i < PERF_COUNTER_KIND_COUNT; i++)
+        counters->fds[i] = -1;
+    fprintf(stderr, "perf_counters_open: perf_event_open is only on Linux\n");
+    return -1;
+}
+
+void perf_counters_close(perf_counters_t *counters)
+{
+    counters->available = 0;
+}
+
+int perf_counters_read(const perf_counters_t *counters, perf_counter_values_t *values)
+{
+    (void)counters;
+    memset(values, 0, sizeof(perf_counter_values_t));
+    return -1;
+}
+
+#endif
+
+void perf_counter_values_add(perf_counter_values_t *to, const perf_counter_values_t *values)
+{
+    for (int i = 0; i < PERF_COUNTER_KIND_COUNT; i++)
+        to->values[i] += values->values[i];
+    to->available |= values->available;
+}
+
+void perf_counter_values_sub(perf_counter_values_t *to, const perf_counter_values_t *values)
+{
+    for (int i = 0; i < PERF_COUNTER_KIND_COUNT; i++)
+        to->values[i] = to->values[i] >= values->values[i] ? to->values[i] - values->values[i] : 0;
+}
+
+double perf_counter_values_per_message(const perf_counter_values_t *values, perf_counter_kind_t kind, uint64_t messages)
+{
+    return messages > 0 ? (double)values->values[kind] / (double)messages : 0.0;
+}
+
+void perf_counters_print(const char *label, const perf_counter_values_t *values, uint64_t messages)
+{
+    printf("%s: %" PRIu64 " messages", label, messages);
+    for (int i = 0; i < PERF_COUNTER_KIND_COUNT; i++)
+    {
+        if (0 == (values->available & (UINT32_C(1) << i)))
+            continue;
+
+        // context switches are rare enough to be more telling as a count
+        if (PERF_COUNTER_CONTEXT_SWITCHES == i)
+        {
+            printf(", %s %" PRIu64, perf_counter_kind_names[i], values->values[i]);
+            continue;
+        }
+
+        printf(", %s %.4g/msg", perf_counter_kind_names[i], perf_counter_values_per_message(values, (perf_counter_kind_t)i, messages));
+        if (PERF_COUNTER_INSTRUCTIONS == i && values->values[PERF_COUNTER_CYCLES] > 0)
+            printf(" (IPC %.2f)", (double)values->values[i] / (double)values->values[PERF_COUNTER_CYCLES]);
+    }
+    printf("\n");
+}
+
+int perf_counter_set_read(const perf_counter_set_t *set, perf_counter_values_t *values)
+{
+    perf_counter_values_t thread_values;
+    int result = -1;
+
+    memset(values, 0, sizeof(perf_counter_values_t));
+    for (size_t i = 0; i < set->count; i++)
+    {
+        if (perf_counters_read(&set->counters[i], &thread_values) == 0)
+        {
+            perf_counter_values_add(values, &thread_values);
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+void perf_counter_set_on_interval(void *clientd, int64_t duration_ns, uint64_t messages)
+{
+    perf_counter_set_t *set = (perf_counter_set_t *)clientd;
+    perf_counter_values_t values, delta;
+    (void)duration_ns;
+
+    if (perf_counter_set_read(set, &values) < 0)
+        return;
+
+    delta = values;
+    perf_counter_values_sub(&delta, &set->last);
+    set->last = values;
+    perf_counters_print("    perf", &delta, messages);
+}
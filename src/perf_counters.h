@@ -0,0 +1,64 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum perf_counter_kind_en
+{
+    PERF_COUNTER_CYCLES = 0,
+    PERF_COUNTER_INSTRUCTIONS = 1,
+    PERF_COUNTER_L1D_MISSES = 2,
+    PERF_COUNTER_LLC_MISSES = 3,
+    PERF_COUNTER_BRANCH_MISSES = 4,
+    PERF_COUNTER_CONTEXT_SWITCHES = 5,
+    PERF_COUNTER_KIND_COUNT
+} perf_counter_kind_t;
+
+/* Counts of the kinds in the available mask, already scaled up when the kernel multiplexed the group. */
+typedef struct perf_counter_values_stct
+{
+    uint64_t values[PERF_COUNTER_KIND_COUNT];
+    uint32_t available;
+} perf_counter_values_t;
+
+/*
+ * perf_event_open counters of one thread, opened as a single group so every kind covers the same time.
+ * Kinds the CPU, the kernel or a VM does not offer are left out rather than failing the whole group. The
+ * owning thread opens them; any thread may read them once ready is set.
+ */
+typedef struct perf_counters_stct
+{
+    int fds[PERF_COUNTER_KIND_COUNT];
+    int slots[PERF_COUNTER_KIND_COUNT];
+    int group_fd;
+    uint32_t available;
+    bool user_only;
+    volatile bool ready;
+} perf_counters_t;
+
+/* Counters of every hot thread of a run, summed for the interval reports of the rate reporter thread. */
+typedef struct perf_counter_set_stct
+{
+    perf_counters_t *counters;
+    size_t count;
+    perf_counter_values_t last;
+} perf_counter_set_t;
+
+/* Opens and starts the counters on the calling thread, -1 when not a single kind could be opened. */
+int perf_counters_open(perf_counters_t *counters);
+void perf_counters_close(perf_counters_t *counters);
+int perf_counters_read(const perf_counters_t *counters, perf_counter_values_t *values);
+
+const char *perf_counter_kind_name(perf_counter_kind_t kind);
+void perf_counter_values_add(perf_counter_values_t *to, const perf_counter_values_t *values);
+void perf_counter_values_sub(perf_counter_values_t *to, const perf_counter_values_t *values);
+double perf_counter_values_per_message(const perf_counter_values_t *values, perf_counter_kind_t kind, uint64_t messages);
+void perf_counters_print(const char *label, const perf_counter_values_t *values, uint64_t messages);
+
+int perf_counter_set_read(const perf_counter_set_t *set, perf_counter_values_t *values);
+/* Prints the counts since the previous interval per message, an on_rate_interval_t for the rate reporter. */
+void perf_counter_set_on_interval(void *clientd, int64_t duration_ns, uint64_t messages);
+
+#endif
@@ -0,0 +1,360 @@
+#if defined(__linux__)
+#define _DEFAULT_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdlib.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+
+#if !defined(_MSC_VER)
+#include <unistd.h>
+#endif
+
+#include <aeronc.h>
+#include <aeron_agent.h>
+#include <concurrent/aeron_atomic.h>
+#include <util/aeron_parse_util.h>
+#include <util/aeron_strutil.h>
+
+#include "sample_util.h"
+#include "samples_configuration.h"
+#include "nms_messages.h"
+#include "bench_message.h"
+#include "histogram.h"
+
+const char usage_str[] =
+    "[-h][-v][-c uri][-C uri][-m messages][-p prefix][-s stream-id][-S stream-id][-w messages]\n"
+    "    -h               help\n"
+    "    -v               show version and exit\n"
+    "    -p prefix        aeron.dir location specified as prefix\n"
+    "    -c uri           ping channel specified in uri\n"
+    "    -C uri           pong channel specified in uri\n"
+    "    -s stream-id     ping stream-id to use\n"
+    "    -S stream-id     pong stream-id to use\n"
+    "    -m messages      number of measured round trips\n"
+    "    -w messages      number of warm-up round trips, not measured\n";
+
+volatile bool running = true;
+
+typedef struct pong_handler_data
+{
+    histogram_t *histogram;
+    bool received;
+    bool record;
+} pong_handler_data_t;
+
+void sigint_handler(int __attribute__((unused)) signal)
+{
+    AERON_PUT_ORDERED(running, false);
+}
+
+inline bool is_running(void)
+{
+    bool result;
+    AERON_GET_VOLATILE(result, running);
+    return result;
+}
+
+void pong_handler(void *clientd, const uint8_t *buffer, size_t length, aeron_header_t __attribute__((unused)) * header)
+{
+    pong_handler_data_t *data = (pong_handler_data_t *)clientd;
+    int64_t now_ns = aeron_nano_clock();
+    XC_HITIME timestamp = bench_message_timestamp(buffer, length);
+
+    if (data->record && timestamp != 0)
+        histogram_record_value(data->histogram, now_ns - (int64_t)timestamp);
+
+    data->received = true;
+}
+
+static int send_ping_and_receive_pong(
+    aeron_exclusive_publication_t *publication,
+    aeron_subscription_t *subscription,
+    pong_handler_data_t *data,
+    struct nms_opra_trade_t *trade,
+    struct nms_opra_quote_t *quote,
+    uint64_t count)
+{
+    aeron_buffer_claim_t buffer_claim;
+
+    for (uint64_t i = 0; i < count && is_running(); i++)
+    {
+        size_t message_length = BENCH_FRAME_HEADER_LENGTH +
+                                ((i % 2 == 0) ? NMS_OPRA_TRADE_LENGTH + 1 : NMS_OPRA_QUOTE_LENGTH + 1);
+        int64_t result;
+
+        while ((result = aeron_exclusive_publication_try_claim(publication, message_length, &buffer_claim)) < 0)
+        {
+            if (result == AERON_PUBLICATION_ERROR || result == AERON_PUBLICATION_CLOSED)
+            {
+                fprintf(stderr, "aeron_exclusive_publication_try_claim: %s\n", aeron_errmsg());
+                return -1;
+            }
+            if (!is_running())
+                return 0;
+            aeron_idle_strategy_busy_spinning_idle(NULL, 0);
+        }
+
+        uint8_t *message = buffer_claim.data + BENCH_FRAME_HEADER_LENGTH;
+        bench_write_frame_header(buffer_claim.data, i, 0, 1);
+        if (i % 2 == 0)
+        {
+            trade->timestamp = aeron_nano_clock();
+            message[0] = NMS_OPRA_TRADE_TYPE;
+            *((struct nms_opra_trade_t *)&message[1]) = *trade;
+        }
+        else
+        {
+            quote->timestamp = aeron_nano_clock();
+            message[0] = NMS_OPRA_QUOTE_TYPE;
+            *((struct nms_opra_quote_t *)&message[1]) = *quote;
+        }
+        aeron_buffer_claim_commit(&buffer_claim);
+
+        data->received = false;
+        while (!data->received)
+        {
+            int fragments_read = aeron_subscription_poll(subscription, pong_handler, data, 1);
+            if (fragments_read < 0)
+            {
+                fprintf(stderr, "aeron_subscription_poll: %s\n", aeron_errmsg());
+                return -1;
+            }
+            if (!is_running())
+                return 0;
+            aeron_idle_strategy_busy_spinning_idle(NULL, fragments_read);
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int status = EXIT_FAILURE, opt;
+
+    const char *ping_channel = DEFAULT_PING_CHANNEL;
+    const char *pong_channel = DEFAULT_PONG_CHANNEL;
+    const char *aeron_dir = NULL;
+    int32_t ping_stream_id = DEFAULT_PING_STREAM_ID;
+    int32_t pong_stream_id = DEFAULT_PONG_STREAM_ID;
+    uint64_t messages = DEFAULT_NUMBER_OF_MESSAGES;
+    uint64_t warm_up_messages = DEFAULT_NUMBER_OF_WARM_UP_MESSAGES;
+
+    while ((opt = getopt(argc, argv, "hvc:C:m:p:s:S:w:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'c':
+        {
+            ping_channel = optarg;
+            break;
+        }
+
+        case 'C':
+        {
+            pong_channel = optarg;
+            break;
+        }
+
+        case 'm':
+        {
+            if (aeron_parse_size64(optarg, &messages) < 0)
+            {
+                fprintf(stderr, "malformed number of messages %s: %s\n", optarg, aeron_errmsg());
+                exit(status);
+            }
+            break;
+        }
+
+        case 'w':
+        {
+            if (aeron_parse_size64(optarg, &warm_up_messages) < 0)
+            {
+                fprintf(stderr, "malformed number of warm-up messages %s: %s\n", optarg, aeron_errmsg());
+                exit(status);
+            }
+            break;
+        }
+
+        case 'p':
+        {
+            aeron_dir = optarg;
+            break;
+        }
+
+        case 's':
+        {
+            ping_stream_id = (int32_t)strtoul(optarg, NULL, 0);
+            break;
+        }
+
+        case 'S':
+        {
+            pong_stream_id = (int32_t)strtoul(optarg, NULL, 0);
+            break;
+        }
+
+        case 'v':
+        {
+            printf(
+                "%s <%s> major %d minor %d patch %d git %s\n",
+                argv[0],
+                aeron_version_full(),
+                aeron_version_major(),
+                aeron_version_minor(),
+                aeron_version_patch(),
+                aeron_version_gitsha());
+            exit(EXIT_SUCCESS);
+        }
+
+        case 'h':
+        default:
+            fprintf(stderr, "Usage: %s %s", argv[0], usage_str);
+            exit(status);
+        }
+    }
+
+    signal(SIGINT, sigint_handler);
+
+    printf("Publishing ping to %s on stream id %" PRId32 "\n", ping_channel, ping_stream_id);
+    printf("Subscribing pong at %s on stream id %" PRId32 "\n", pong_channel, pong_stream_id);
+
+    aeron_context_t *context = NULL;
+    aeron_t *aeron = NULL;
+    aeron_async_add_exclusive_publication_t *async_publication = NULL;
+    aeron_exclusive_publication_t *publication = NULL;
+    aeron_async_add_subscription_t *async_subscription = NULL;
+    aeron_subscription_t *subscription = NULL;
+    histogram_t histogram = {0};
+    pong_handler_data_t data = {
+        .histogram = &histogram,
+    };
+
+    if (histogram_init(&histogram, DEFAULT_HISTOGRAM_HIGHEST_TRACKABLE_VALUE, DEFAULT_HISTOGRAM_SIGNIFICANT_FIGURES) < 0)
+    {
+        fprintf(stderr, "histogram_init: %s\n", aeron_errmsg());
+        goto cleanup;
+    }
+
+    if (aeron_context_init(&context) < 0)
+    {
+        fprintf(stderr, "aeron_context_init: %s\n", aeron_errmsg());
+        goto cleanup;
+    }
+
+    if (NULL != aeron_dir)
+    {
+        if (aeron_context_set_dir(context, aeron_dir) < 0)
+        {
+            fprintf(stderr, "aeron_context_set_dir: %s\n", aeron_errmsg());
+            goto cleanup;
+        }
+    }
+
+    if (aeron_init(&aeron, context) < 0)
+    {
+        fprintf(stderr, "aeron_init: %s\n", aeron_errmsg());
+        goto cleanup;
+    }
+
+    if (aeron_start(aeron) < 0)
+    {
+        fprintf(stderr, "aeron_start: %s\n", aeron_errmsg());
+        goto cleanup;
+    }
+
+    if (aeron_async_add_subscription(
+            &async_subscription,
+            aeron,
+            pong_channel,
+            pong_stream_id,
+            print_available_image,
+            NULL,
+            print_unavailable_image,
+            NULL) < 0)
+    {
+        fprintf(stderr, "aeron_async_add_subscription: %s\n", aeron_errmsg());
+        goto cleanup;
+    }
+
+    while (NULL == subscription)
+    {
+        if (aeron_async_add_subscription_poll(&subscription, async_subscription) < 0)
+        {
+            fprintf(stderr, "aeron_async_add_subscription_poll: %s\n", aeron_errmsg());
+            goto cleanup;
+        }
+        sched_yield();
+    }
+
+    printf("Subscription channel status %" PRIu64 "\n", aeron_subscription_channel_status(subscription));
+
+    if (aeron_async_add_exclusive_publication(&async_publication, aeron, ping_channel, ping_stream_id) < 0)
+    {
+        fprintf(stderr, "aeron_async_add_exclusive_publication: %s\n", aeron_errmsg());
+        goto cleanup;
+    }
+
+    while (NULL == publication)
+    {
+        if (aeron_async_add_exclusive_publication_poll(&publication, async_publication) < 0)
+        {
+            fprintf(stderr, "aeron_async_add_exclusive_publication_poll: %s\n", aeron_errmsg());
+            goto cleanup;
+        }
+        sched_yield();
+    }
+
+    printf("Publication channel status %" PRIu64 "\n", aeron_exclusive_publication_channel_status(publication));
+
+    printf("Waiting for pong to connect\n");
+    while (is_running() && !(aeron_subscription_is_connected(subscription) && aeron_exclusive_publication_is_connected(publication)))
+    {
+        sched_yield();
+    }
+
+    struct nms_opra_trade_t trade = bench_sample_trade;
+    struct nms_opra_quote_t quote = bench_sample_quote;
+
+    printf("Warming up with %" PRIu64 " round trips\n", warm_up_messages);
+    if (send_ping_and_receive_pong(publication, subscription, &data, &trade, &quote, warm_up_messages) < 0)
+    {
+        goto cleanup;
+    }
+
+    printf("Pinging %" PRIu64 " round trips\n", messages);
+    data.record = true;
+    int64_t start_timestamp_ns = aeron_nano_clock();
+    if (send_ping_and_receive_pong(publication, subscription, &data, &trade, &quote, messages) < 0)
+    {
+        goto cleanup;
+    }
+    int64_t duration_ns = aeron_nano_clock() - start_timestamp_ns;
+
+    printf("Done pinging.\n");
+
+    printf(
+        "Total: %" PRId64 "ms, %.04g round trips/sec, totals %" PRId64 " round trips\n",
+        duration_ns / (1000 * 1000),
+        ((double)histogram.total_count * (double)(1000 * 1000 * 1000) / (double)duration_ns),
+        histogram.total_count);
+    print_latency_report("Round trip", &histogram);
+
+    status = EXIT_SUCCESS;
+
+cleanup:
+    aeron_exclusive_publication_close(publication, NULL, NULL);
+    aeron_subscription_close(subscription, NULL, NULL);
+    aeron_close(aeron);
+    aeron_context_close(context);
+    histogram_close(&histogram);
+
+    return status;
+}
+
+extern bool is_running(void);
@@ -0,0 +1,255 @@
+#if defined(__linux__)
+#define _DEFAULT_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdlib.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+
+#if !defined(_MSC_VER)
+#include <unistd.h>
+#endif
+
+#include <aeronc.h>
+#include <aeron_agent.h>
+#include <concurrent/aeron_atomic.h>
+#include <util/aeron_parse_util.h>
+#include <util/aeron_strutil.h>
+
+#include "sample_util.h"
+#include "samples_configuration.h"
+
+const char usage_str[] =
+    "[-h][-v][-c uri][-C uri][-p prefix][-s stream-id][-S stream-id]\n"
+    "    -h               help\n"
+    "    -v               show version and exit\n"
+    "    -p prefix        aeron.dir location specified as prefix\n"
+    "    -c uri           ping channel specified in uri\n"
+    "    -C uri           pong channel specified in uri\n"
+    "    -s stream-id     ping stream-id to use\n"
+    "    -S stream-id     pong stream-id to use\n";
+
+volatile bool running = true;
+
+typedef struct ping_handler_data
+{
+    aeron_exclusive_publication_t *publication;
+    uint64_t messages;
+    uint64_t back_pressure_count;
+} ping_handler_data_t;
+
+void sigint_handler(int __attribute__((unused)) signal)
+{
+    AERON_PUT_ORDERED(running, false);
+}
+
+inline bool is_running(void)
+{
+    bool result;
+    AERON_GET_VOLATILE(result, running);
+    return result;
+}
+
+void ping_handler(void *clientd, const uint8_t *buffer, size_t length, aeron_header_t __attribute__((unused)) * header)
+{
+    ping_handler_data_t *data = (ping_handler_data_t *)clientd;
+    aeron_buffer_claim_t buffer_claim;
+    int64_t result;
+
+    while ((result = aeron_exclusive_publication_try_claim(data->publication, length, &buffer_claim)) < 0)
+    {
+        if (result == AERON_PUBLICATION_ERROR || result == AERON_PUBLICATION_CLOSED)
+        {
+            fprintf(stderr, "aeron_exclusive_publication_try_claim: %s\n", aeron_errmsg());
+            sigint_handler(0);
+            return;
+        }
+        if (!is_running())
+            return;
+        data->back_pressure_count++;
+        aeron_idle_strategy_busy_spinning_idle(NULL, 0);
+    }
+
+    memcpy(buffer_claim.data, buffer, length);
+    aeron_buffer_claim_commit(&buffer_claim);
+    data->messages++;
+}
+
+int main(int argc, char **argv)
+{
+    int status = EXIT_FAILURE, opt;
+
+    const char *ping_channel = DEFAULT_PING_CHANNEL;
+    const char *pong_channel = DEFAULT_PONG_CHANNEL;
+    const char *aeron_dir = NULL;
+    int32_t ping_stream_id = DEFAULT_PING_STREAM_ID;
+    int32_t pong_stream_id = DEFAULT_PONG_STREAM_ID;
+
+    while ((opt = getopt(argc, argv, "hvc:C:p:s:S:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'c':
+        {
+            ping_channel = optarg;
+            break;
+        }
+
+        case 'C':
+        {
+            pong_channel = optarg;
+            break;
+        }
+
+        case 'p':
+        {
+            aeron_dir = optarg;
+            break;
+        }
+
+        case 's':
+        {
+            ping_stream_id = (int32_t)strtoul(optarg, NULL, 0);
+            break;
+        }
+
+        case 'S':
+        {
+            pong_stream_id = (int32_t)strtoul(optarg, NULL, 0);
+            break;
+        }
+
+        case 'v':
+        {
+            printf(
+                "%s <%s> major %d minor %d patch %d git %s\n",
+                argv[0],
+                aeron_version_full(),
+                aeron_version_major(),
+                aeron_version_minor(),
+                aeron_version_patch(),
+                aeron_version_gitsha());
+            exit(EXIT_SUCCESS);
+        }
+
+        case 'h':
+        default:
+            fprintf(stderr, "Usage: %s %s", argv[0], usage_str);
+            exit(status);
+        }
+    }
+
+    signal(SIGINT, sigint_handler);
+
+    printf("Subscribing ping at %s on stream id %" PRId32 "\n", ping_channel, ping_stream_id);
+    printf("Publishing pong to %s on stream id %" PRId32 "\n", pong_channel, pong_stream_id);
+
+    aeron_context_t *context = NULL;
+    aeron_t *aeron = NULL;
+    aeron_async_add_exclusive_publication_t *async_publication = NULL;
+    aeron_async_add_subscription_t *async_subscription = NULL;
+    aeron_subscription_t *subscription = NULL;
+    ping_handler_data_t data = {0};
+
+    if (aeron_context_init(&context) < 0)
+    {
+        fprintf(stderr, "aeron_context_init: %s\n", aeron_errmsg());
+        goto cleanup;
+    }
+
+    if (NULL != aeron_dir)
+    {
+        if (aeron_context_set_dir(context, aeron_dir) < 0)
+        {
+            fprintf(stderr, "aeron_context_set_dir: %s\n", aeron_errmsg());
+            goto cleanup;
+        }
+    }
+
+    if (aeron_init(&aeron, context) < 0)
+    {
+        fprintf(stderr, "aeron_init: %s\n", aeron_errmsg());
+        goto cleanup;
+    }
+
+    if (aeron_start(aeron) < 0)
+    {
+        fprintf(stderr, "aeron_start: %s\n", aeron_errmsg());
+        goto cleanup;
+    }
+
+    if (aeron_async_add_exclusive_publication(&async_publication, aeron, pong_channel, pong_stream_id) < 0)
+    {
+        fprintf(stderr, "aeron_async_add_exclusive_publication: %s\n", aeron_errmsg());
+        goto cleanup;
+    }
+
+    while (NULL == data.publication)
+    {
+        if (aeron_async_add_exclusive_publication_poll(&data.publication, async_publication) < 0)
+        {
+            fprintf(stderr, "aeron_async_add_exclusive_publication_poll: %s\n", aeron_errmsg());
+            goto cleanup;
+        }
+        sched_yield();
+    }
+
+    printf("Publication channel status %" PRIu64 "\n", aeron_exclusive_publication_channel_status(data.publication));
+
+    if (aeron_async_add_subscription(
+            &async_subscription,
+            aeron,
+            ping_channel,
+            ping_stream_id,
+            print_available_image,
+            NULL,
+            print_unavailable_image,
+            NULL) < 0)
+    {
+        fprintf(stderr, "aeron_async_add_subscription: %s\n", aeron_errmsg());
+        goto cleanup;
+    }
+
+    while (NULL == subscription)
+    {
+        if (aeron_async_add_subscription_poll(&subscription, async_subscription) < 0)
+        {
+            fprintf(stderr, "aeron_async_add_subscription_poll: %s\n", aeron_errmsg());
+            goto cleanup;
+        }
+        sched_yield();
+    }
+
+    printf("Subscription channel status %" PRIu64 "\n", aeron_subscription_channel_status(subscription));
+
+    while (is_running())
+    {
+        int fragments_read = aeron_subscription_poll(subscription, ping_handler, &data, DEFAULT_FRAGMENT_COUNT_LIMIT);
+        if (fragments_read < 0)
+        {
+            fprintf(stderr, "aeron_subscription_poll: %s\n", aeron_errmsg());
+            goto cleanup;
+        }
+
+        aeron_idle_strategy_busy_spinning_idle(NULL, fragments_read);
+    }
+
+    printf("Done echoing.\n");
+    printf("Echoed %" PRIu64 " messages, back pressure count %" PRIu64 "\n", data.messages, data.back_pressure_count);
+
+    status = EXIT_SUCCESS;
+
+cleanup:
+    aeron_subscription_close(subscription, NULL, NULL);
+    aeron_exclusive_publication_close(data.publication, NULL, NULL);
+    aeron_close(aeron);
+    aeron_context_close(context);
+
+    return status;
+}
+
+extern bool is_running(void);
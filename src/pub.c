@@ -25,6 +25,7 @@
 #include <stdio.h>
 #include <inttypes.h>
 #include <string.h>
+#include <pthread.h>
 
 #if !defined(_MSC_VER)
 #include <unistd.h>
@@ -40,22 +41,113 @@
 #include "sample_util.h"
 #include "samples_configuration.h"
 #include "nms_messages.h"
+#include "bench_message.h"
+#include "send_schedule.h"
+#include "affinity.h"
+#include "feed_generator.h"
+#include "capture.h"
+#include "histogram.h"
+#include "embedded_driver.h"
+#include "json_report.h"
+#include "idle_strategy.h"
+#include "cpu_time.h"
+#include "bench_counters.h"
+#include "perf_counters.h"
+#include "bench_clock.h"
+#include "back_pressure.h"
 #include "xtypes.h"
 
 const char usage_str[] =
-    "[-h][-P][-v][-c uri][-L length][-l linger][-m messages][-p prefix][-s stream-id]\n"
+    "[-h][-P][-v][-x][-S][-H][-T][-J][-K][-E][-O][-a cpus][-C cpu][-N node][-b batch][-k contracts][-z exponent][-Q quotes][-A messages][-r rate][-R arrivals][-F capture][-X speed][-w messages][-t threads][-o clock][-i idle][-c uri][-L length][-l linger][-m messages][-p prefix][-D mode][-I idle][-s stream-id]\n"
     "    -h               help\n"
     "    -v               show version and exit\n"
     "    -P               print progress\n"
+    "    -J               print a JSON summary line at the end, for sweep scripts\n"
+    "    -E               count cycles, instructions, cache and branch misses and context switches of each publisher\n"
+    "                     thread with perf_event_open, reported per message with -P and at the end\n"
+    "    -O               report the cost of a clock read before publishing\n"
+    "    -K               export messages, bytes, back pressure and claims per thread as counters in the CnC file\n"
     "    -x               exclusive\n"
+    "    -b batch         pack up to batch messages into one claim, bounded by the MTU (requires -x)\n"
+    "    -k contracts     contract universe of the generated feed, k and M are decimal (e.g. 1.5M)\n"
+    "    -z exponent      zipf exponent of symbol popularity, 0 is uniform (default 1.0)\n"
+    "    -Q quotes        quotes per trade (default 1, OPRA is around 100)\n"
+    "    -L length        zero pad every frame to at least length bytes, for message size sweeps\n"
+    "    -A messages      pregenerated messages in the feed arena, a power of two (default 1M)\n"
+    "    -r rate          open-loop target rate in msgs/sec (e.g. 2M/s), timestamps are the intended send time\n"
+    "    -R arrivals      arrival gaps at the target rate: fixed (default), poisson or burst:N\n"
+    "    -F capture       replay a capture file instead of the generated feed, one record per claim\n"
+    "    -X speed         replay pacing, 0 as fast as possible (default), 1 original, 2 twice as fast\n"
+    "    -w messages      warm-up messages before the measured run, split across threads, each thread ends its\n"
+    "                     share with an in-band marker the subscriber resets its statistics on (default 100k, 0 none)\n"
+    "    -t threads       number of publisher threads, each with its own exclusive publication with -x,\n"
+    "                     otherwise all threads offer concurrently to one shared publication\n"
+    "    -o clock         clock for timestamps and send latency: auto (default), tsc or monotonic\n"
+    "    -i idle          back pressure idle strategy: busy-spin (default), noop, yield, backoff or sleeping[:duration]\n"
+    "    -a cpus          pin publisher threads to cpus round robin (e.g. 2,3,8-11)\n"
+    "    -C cpu           pin the progress reporter thread to cpu\n"
+    "    -N node          run on NUMA node and allocate the feed arena and buffers there\n"
+    "    -S               give each publisher thread its own stream-id (stream-id + thread index)\n"
+    "    -H               record send latency, from the first claim/offer attempt until it succeeds\n"
+    "    -T               time back pressure stalls per reason and sample how far the consumer trails the position\n"
     "    -p prefix        aeron.dir location specified as prefix\n"
+    "    -D mode          run an embedded media driver: dedicated, shared-network or shared\n"
+    "    -I idle          idle strategy of the embedded driver agents (e.g. noop, busy_spin, yield, sleep-ns)\n"
     "    -c uri           use channel specified in uri\n"
     "    -s stream-id     stream-id to use\n"
     "    -l linger        linger at end of publishing for linger seconds\n"
-    "    -m messages      number of messages to send (0: never stops)\n";
+    "    -m messages      number of messages to send, split across threads (0: never stops)\n";
 
 volatile bool running = true;
 
+typedef struct publisher_stct
+{
+    pthread_t thread;
+    size_t index;
+    int cpu;
+    int32_t stream_id;
+    int32_t session_id;
+    aeron_exclusive_publication_t *epublication;
+    aeron_publication_t *publication;
+    bool owns_publication;
+    size_t max_payload_length;
+    uint8_t *message;
+
+    uint64_t messages;
+    uint64_t batch_size;
+    size_t frame_length;
+    const feed_generator_t *generator;
+    uint64_t arena_offset;
+    capture_reader_t *capture;
+    double replay_speed;
+    uint64_t warm_up_messages;
+    uint16_t warm_up_sources;
+    uint64_t sequence_base;
+    send_schedule_t schedule;
+    rate_reporter_writer_t *rate_reporter_writer;
+    pthread_barrier_t *start_barrier;
+    histogram_t send_latency_histogram;
+    bool record_send_latency;
+    idle_strategy_t idle_strategy;
+    bench_counters_t counters;
+    bool export_counters;
+    perf_counters_t *perf_counters;
+    perf_counter_values_t perf_values;
+    bench_clock_t clock;
+    back_pressure_stats_t back_pressure;
+
+    uint64_t back_pressure_count;
+    uint64_t message_sent_count;
+    uint64_t bytes_sent_count;
+    uint64_t claim_count;
+    uint64_t skipped_record_count;
+    uint64_t skipped_warm_up_record_count;
+    int64_t max_schedule_lag_ns;
+    int64_t start_timestamp_ns;
+    int64_t end_timestamp_ns;
+    int64_t cpu_time_ns;
+} publisher_t;
+
 void sigint_handler(int __attribute__((unused)) signal)
 {
     AERON_PUT_ORDERED(running, false);
@@ -68,65 +160,850 @@ inline bool is_running(void)
     return result;
 }
 
-int main(int argc, char **argv)
-{
-    int status = EXIT_FAILURE, opt;
+static void publisher_update_counters(publisher_t *publisher)
+{
+    bench_counters_set(&publisher->counters, BENCH_COUNTER_MESSAGES, (int64_t)publisher->message_sent_count);
+    bench_counters_set(&publisher->counters, BENCH_COUNTER_BYTES, (int64_t)publisher->bytes_sent_count);
+    bench_counters_set(&publisher->counters, BENCH_COUNTER_BACK_PRESSURE, (int64_t)publisher->back_pressure_count);
+    bench_counters_set(&publisher->counters, BENCH_COUNTER_CLAIMS, (int64_t)publisher->claim_count);
+}
+
+/* Publishes the totals every BENCH_COUNTERS_UPDATE_INTERVAL steps of progress, a mask test otherwise. */
+static inline void publisher_tick_counters(publisher_t *publisher, uint64_t progress)
+{
+#if BENCH_INSTRUMENTATION != BENCH_INSTRUMENTATION_NONE
+    if (publisher->export_counters && (progress & (BENCH_COUNTERS_UPDATE_INTERVAL - 1)) == 0)
+        publisher_update_counters(publisher);
+#else
+    (void)publisher;
+    (void)progress;
+#endif
+}
+
+static void publisher_record_position_lag(publisher_t *publisher, histogram_t *histogram)
+{
+    if (NULL != publisher->epublication)
+    {
+        back_pressure_record_lag(
+            &publisher->back_pressure,
+            histogram,
+            aeron_exclusive_publication_position(publisher->epublication),
+            aeron_exclusive_publication_position_limit(publisher->epublication));
+    }
+    else
+    {
+        back_pressure_record_lag(
+            &publisher->back_pressure,
+            histogram,
+            aeron_publication_position(publisher->publication),
+            aeron_publication_position_limit(publisher->publication));
+    }
+}
+
+/* Samples the position lag every BACK_PRESSURE_LAG_SAMPLE_INTERVAL steps of progress, a mask test otherwise. */
+static inline void publisher_tick_position_lag(publisher_t *publisher, uint64_t progress)
+{
+    if (publisher->back_pressure.record_stalls && (progress & (BACK_PRESSURE_LAG_SAMPLE_INTERVAL - 1)) == 0)
+        publisher_record_position_lag(publisher, &publisher->back_pressure.lag_histogram);
+}
+
+/* Counts a failed claim or offer by reason, the first of a stall is stamped and samples the position lag. */
+static inline void publisher_on_back_pressure(publisher_t *publisher, int64_t result, bool stall_start)
+{
+    back_pressure_stats_t *stats = &publisher->back_pressure;
+    bool record_stall = stall_start && stats->record_stalls;
+
+    publisher->back_pressure_count++;
+    back_pressure_on_attempt(stats, back_pressure_reason(result), record_stall, record_stall ? bench_clock_ns(&publisher->clock) : 0);
+    if (record_stall)
+        publisher_record_position_lag(publisher, &stats->stall_lag_histogram);
+}
+
+static inline void publisher_on_stall_end(publisher_t *publisher)
+{
+    if (publisher->back_pressure.record_stalls)
+        back_pressure_on_stall_end(&publisher->back_pressure, bench_clock_ns(&publisher->clock));
+}
+
+static inline void publisher_flush_progress(publisher_t *publisher)
+{
+    if (NULL != publisher->rate_reporter_writer)
+        rate_reporter_writer_flush(publisher->rate_reporter_writer);
+}
+
+static void publish_exclusive(publisher_t *publisher)
+{
+    const feed_generator_t *generator = publisher->generator;
+    const uint64_t arena_offset = publisher->arena_offset;
+    aeron_buffer_claim_t buffer_claim;
+    const bool use_rate = publisher->schedule.rate > 0;
+    const uint64_t messages = publisher->messages;
+    idle_strategy_t *idle_strategy = &publisher->idle_strategy;
+    bool back_pressured = false;
+    int64_t send_start_ns = 0;
+
+    for (uint64_t i = 0; (messages == 0 || i < messages) && is_running();)
+    {
+        int64_t now_ns = 0;
+        if (use_rate)
+        {
+            while ((now_ns = bench_clock_ns(&publisher->clock)) < send_schedule_intended_ns(&publisher->schedule, i) && is_running())
+            {
+                publisher_flush_progress(publisher);
+                aeron_idle_strategy_busy_spinning_idle(NULL, 0);
+            }
+        }
+
+        uint64_t batch_count = 0;
+        size_t batch_length = BENCH_FRAME_HEADER_LENGTH;
+        while (batch_count < publisher->batch_size && batch_count < UINT16_MAX && (messages == 0 || i + batch_count < messages))
+        {
+            size_t next_length = feed_generator_message_length(generator, arena_offset + i + batch_count);
+            if (batch_count > 0 && batch_length + next_length > publisher->max_payload_length)
+                break;
+
+            // at a target rate only messages that are already due go into the batch
+            if (batch_count > 0 && use_rate && send_schedule_intended_ns(&publisher->schedule, i + batch_count) > now_ns)
+                break;
+
+            batch_length += next_length;
+            batch_count++;
+        }
+        size_t messages_length = batch_length;
+        if (batch_length < publisher->frame_length)
+            batch_length = publisher->frame_length;
+
+        if (publisher->record_send_latency && send_start_ns == 0)
+            send_start_ns = bench_clock_ns(&publisher->clock);
+
+        int64_t result = aeron_exclusive_publication_try_claim(
+            publisher->epublication,
+            batch_length,
+            &buffer_claim);
+
+        if (result == AERON_PUBLICATION_ERROR || result == AERON_PUBLICATION_CLOSED)
+        {
+            fprintf(stderr, "aeron_exclusive_publication_try_claim: %s\n", aeron_errmsg());
+            break;
+        }
+        else if (result < 0)
+        {
+            publisher_on_back_pressure(publisher, result, !back_pressured);
+            back_pressured = true;
+            publisher_tick_counters(publisher, publisher->back_pressure_count);
+            publisher_flush_progress(publisher);
+            idle_strategy_idle(idle_strategy, 0);
+        }
+        else
+        {
+            if (back_pressured)
+            {
+                publisher_on_stall_end(publisher);
+                // resets a backoff, so the next back pressure starts spinning again
+                idle_strategy_idle(idle_strategy, 1);
+                back_pressured = false;
+            }
+
+            uint8_t *data = buffer_claim.data;
+            bench_write_frame_header(data, publisher->sequence_base + i, (uint16_t)publisher->index, (uint16_t)batch_count);
+            data += BENCH_FRAME_HEADER_LENGTH;
+
+            if (use_rate)
+            {
+                for (uint64_t j = 0; j < batch_count; j++)
+                    data += feed_generator_write(generator, arena_offset + i + j, data, send_schedule_intended_ns(&publisher->schedule, i + j));
+
+                int64_t lag_ns = bench_clock_ns(&publisher->clock) - send_schedule_intended_ns(&publisher->schedule, i);
+                if (lag_ns > publisher->max_schedule_lag_ns)
+                    publisher->max_schedule_lag_ns = lag_ns;
+            }
+            else
+            {
+                for (uint64_t j = 0; j < batch_count; j++)
+                    data += feed_generator_write(generator, arena_offset + i + j, data, bench_clock_ns(&publisher->clock));
+            }
+
+            if (batch_length > messages_length)
+                memset(data, 0, batch_length - messages_length);
+
+            aeron_buffer_claim_commit(&buffer_claim);
+            if (publisher->record_send_latency)
+            {
+                histogram_record_value(&publisher->send_latency_histogram, bench_clock_ns(&publisher->clock) - send_start_ns);
+                send_start_ns = 0;
+            }
+
+            if (NULL != publisher->rate_reporter_writer)
+                rate_reporter_writer_on_messages(publisher->rate_reporter_writer, batch_count, batch_length);
+
+            publisher->claim_count++;
+            publisher->message_sent_count += batch_count;
+            publisher->bytes_sent_count += batch_length;
+            publisher_tick_counters(publisher, publisher->claim_count);
+            publisher_tick_position_lag(publisher, publisher->claim_count);
+            i += batch_count;
+        }
+    }
+}
+
+static void publish_shared(publisher_t *publisher)
+{
+    const feed_generator_t *generator = publisher->generator;
+    const uint64_t arena_offset = publisher->arena_offset;
+    const bool use_rate = publisher->schedule.rate > 0;
+    const uint64_t messages = publisher->messages;
+    uint8_t *message = publisher->message;
+    idle_strategy_t *idle_strategy = &publisher->idle_strategy;
+    size_t message_length;
+
+    for (uint64_t i = 0; (messages == 0 || i < messages) && is_running(); i++)
+    {
+        int64_t timestamp_ns;
+        if (use_rate)
+        {
+            timestamp_ns = send_schedule_intended_ns(&publisher->schedule, i);
+            while (bench_clock_ns(&publisher->clock) < timestamp_ns && is_running())
+            {
+                publisher_flush_progress(publisher);
+                aeron_idle_strategy_busy_spinning_idle(NULL, 0);
+            }
+        }
+        else
+        {
+            timestamp_ns = bench_clock_ns(&publisher->clock);
+        }
+
+        bench_write_frame_header(message, publisher->sequence_base + i, (uint16_t)publisher->index, 1);
+        message_length = BENCH_FRAME_HEADER_LENGTH +
+                         feed_generator_write(generator, arena_offset + i, message + BENCH_FRAME_HEADER_LENGTH, timestamp_ns);
+        if (message_length < publisher->frame_length)
+        {
+            memset(message + message_length, 0, publisher->frame_length - message_length);
+            message_length = publisher->frame_length;
+        }
+        int64_t send_start_ns = publisher->record_send_latency ? bench_clock_ns(&publisher->clock) : 0;
+        bool back_pressured = false;
+        int64_t result;
+        while ((result = aeron_publication_offer(publisher->publication, message, message_length, NULL, NULL)) < 0)
+        {
+            if (result == AERON_PUBLICATION_ERROR || result == AERON_PUBLICATION_CLOSED)
+            {
+                fprintf(stderr, "aeron_publication_offer: %s\n", aeron_errmsg());
+                return;
+            }
+            publisher_on_back_pressure(publisher, result, !back_pressured);
+            if (!is_running())
+                break;
+            back_pressured = true;
+            publisher_tick_counters(publisher, publisher->back_pressure_count);
+            publisher_flush_progress(publisher);
+            idle_strategy_idle(idle_strategy, 0);
+        }
+        if (back_pressured)
+        {
+            if (result >= 0)
+                publisher_on_stall_end(publisher);
+            idle_strategy_idle(idle_strategy, 1);
+        }
+
+        if (publisher->record_send_latency)
+            histogram_record_value(&publisher->send_latency_histogram, bench_clock_ns(&publisher->clock) - send_start_ns);
+
+        if (use_rate)
+        {
+            int64_t lag_ns = bench_clock_ns(&publisher->clock) - timestamp_ns;
+            if (lag_ns > publisher->max_schedule_lag_ns)
+                publisher->max_schedule_lag_ns = lag_ns;
+        }
+
+        if (NULL != publisher->rate_reporter_writer)
+            rate_reporter_writer_on_messages(publisher->rate_reporter_writer, 1, message_length);
+
+        publisher->message_sent_count++;
+        publisher->bytes_sent_count += message_length;
+        publisher_tick_counters(publisher, publisher->message_sent_count);
+        publisher_tick_position_lag(publisher, publisher->message_sent_count);
+    }
+}
+
+static inline int64_t publisher_try_claim(publisher_t *publisher, size_t length, aeron_buffer_claim_t *buffer_claim)
+{
+    if (NULL != publisher->epublication)
+        return aeron_exclusive_publication_try_claim(publisher->epublication, length, buffer_claim);
+
+    return aeron_publication_try_claim(publisher->publication, length, buffer_claim);
+}
+
+/*
+ * Replays a capture one record per claim, copied straight from the mapping into the term buffer. The frame
+ * header is rewritten with this publisher's sequence and every message is stamped with its send time.
+ */
+static void publish_replay(publisher_t *publisher)
+{
+    capture_reader_t *capture = publisher->capture;
+    const double speed = publisher->replay_speed;
+    const uint64_t messages = publisher->messages;
+    aeron_buffer_claim_t buffer_claim;
+    capture_record_t record;
+    int64_t first_record_ns = 0;
+    bool has_first_record = false;
+    uint64_t i = 0;
+    idle_strategy_t *idle_strategy = &publisher->idle_strategy;
+
+    bool has_record = capture_reader_next(capture, &record);
+
+    while (has_record && (messages == 0 || i < messages) && is_running())
+    {
+        // a capture of a warmed up run holds the markers and the flagged warm-up frames, this run sends its own
+        if (NULL != bench_warm_up_end(record.fragment, record.length))
+        {
+            has_record = capture_reader_next(capture, &record);
+            continue;
+        }
+
+        if (record.length >= BENCH_FRAME_HEADER_LENGTH &&
+            (((const struct bench_frame_header_t *)record.fragment)->source_id & BENCH_WARM_UP_SOURCE_FLAG) != 0)
+        {
+            publisher->skipped_warm_up_record_count++;
+            has_record = capture_reader_next(capture, &record);
+            continue;
+        }
+
+        if (record.length <= BENCH_FRAME_HEADER_LENGTH || record.length > publisher->max_payload_length)
+        {
+            publisher->skipped_record_count++;
+            has_record = capture_reader_next(capture, &record);
+            continue;
+        }
+
+        // pacing starts at the first replayed record, not at the skipped warm-up ahead of it
+        if (!has_first_record)
+        {
+            first_record_ns = record.timestamp_ns;
+            has_first_record = true;
+        }
+
+        int64_t timestamp_ns;
+        if (speed > 0.0)
+        {
+            timestamp_ns = publisher->start_timestamp_ns + (int64_t)((double)(record.timestamp_ns - first_record_ns) / speed);
+            while (bench_clock_ns(&publisher->clock) < timestamp_ns && is_running())
+            {
+                publisher_flush_progress(publisher);
+                aeron_idle_strategy_busy_spinning_idle(NULL, 0);
+            }
+        }
+        else
+        {
+            timestamp_ns = bench_clock_ns(&publisher->clock);
+        }
+
+        int64_t result;
+        bool back_pressured = false;
+        while ((result = publisher_try_claim(publisher, record.length, &buffer_claim)) < 0)
+        {
+            if (result == AERON_PUBLICATION_ERROR || result == AERON_PUBLICATION_CLOSED)
+            {
+                fprintf(stderr, "replay try_claim: %s\n", aeron_errmsg());
+                return;
+            }
+            publisher_on_back_pressure(publisher, result, !back_pressured);
+            if (!is_running())
+                return;
+            back_pressured = true;
+            publisher_tick_counters(publisher, publisher->back_pressure_count);
+            publisher_flush_progress(publisher);
+            idle_strategy_idle(idle_strategy, 0);
+        }
+        if (back_pressured)
+        {
+            publisher_on_stall_end(publisher);
+            idle_strategy_idle(idle_strategy, 1);
+        }
+
+        uint8_t *data = buffer_claim.data;
+        uint16_t count = 0;
+        memcpy(data, record.fragment, record.length);
+        for (size_t offset = BENCH_FRAME_HEADER_LENGTH; offset < record.length && count < UINT16_MAX; count++)
+        {
+            size_t message_length = bench_typed_message_length(data[offset]);
+            if (message_length == 0 || offset + message_length > record.length)
+                break;
+
+            ((struct nms_opra_trade_t *)(data + offset + 1))->timestamp = (XC_HITIME)timestamp_ns;
+            offset += message_length;
+        }
+        bench_write_frame_header(data, publisher->sequence_base + i, (uint16_t)publisher->index, count);
+        aeron_buffer_claim_commit(&buffer_claim);
+
+        if (speed > 0.0)
+        {
+            int64_t lag_ns = bench_clock_ns(&publisher->clock) - timestamp_ns;
+            if (lag_ns > publisher->max_schedule_lag_ns)
+                publisher->max_schedule_lag_ns = lag_ns;
+        }
+
+        if (NULL != publisher->rate_reporter_writer)
+            rate_reporter_writer_on_messages(publisher->rate_reporter_writer, count, record.length);
+
+        publisher->claim_count++;
+        publisher->message_sent_count += count;
+        publisher->bytes_sent_count += record.length;
+        publisher_tick_counters(publisher, publisher->claim_count);
+        publisher_tick_position_lag(publisher, publisher->claim_count);
+        i += count;
+
+        has_record = capture_reader_next(capture, &record);
+    }
+}
+
+/* Claims outside the measured run, back pressure is waited out without being counted. */
+static int publisher_claim_unmeasured(publisher_t *publisher, size_t length, aeron_buffer_claim_t *buffer_claim)
+{
+    int64_t result;
+
+    while ((result = publisher_try_claim(publisher, length, buffer_claim)) < 0)
+    {
+        if (result == AERON_PUBLICATION_ERROR || result == AERON_PUBLICATION_CLOSED)
+        {
+            fprintf(stderr, "publisher_claim_unmeasured: %s\n", aeron_errmsg());
+            return -1;
+        }
+        if (!is_running())
+            return -1;
+        idle_strategy_idle(&publisher->idle_strategy, 0);
+    }
+    idle_strategy_idle(&publisher->idle_strategy, 1);
+
+    return 0;
+}
+
+/*
+ * Sends the warm-up messages one per claim, as fast as back pressure allows and padded like the measured
+ * frames, so both ends fault in their pages and fill their caches and the book before anything is measured.
+ * A replay warms up with the sample trade, the capture is kept for the measured run.
+ */
+static int publish_warm_up(publisher_t *publisher)
+{
+    aeron_buffer_claim_t buffer_claim;
+    size_t max_length = publisher->frame_length < publisher->max_payload_length ? publisher->frame_length : publisher->max_payload_length;
+
+    for (uint64_t i = 0; i < publisher->warm_up_messages; i++)
+    {
+        size_t message_length = NULL != publisher->capture ?
+            NMS_OPRA_TRADE_LENGTH + 1 : feed_generator_message_length(publisher->generator, publisher->arena_offset + i);
+        size_t length = BENCH_FRAME_HEADER_LENGTH + message_length;
+        if (length < max_length)
+            length = max_length;
+
+        if (publisher_claim_unmeasured(publisher, length, &buffer_claim) < 0)
+            return -1;
+
+        uint8_t *data = buffer_claim.data;
+        int64_t timestamp_ns = bench_clock_ns(&publisher->clock);
+        bench_write_frame_header(data, i, (uint16_t)(publisher->index | BENCH_WARM_UP_SOURCE_FLAG), 1);
+        data += BENCH_FRAME_HEADER_LENGTH;
+        if (NULL != publisher->capture)
+        {
+            data[0] = NMS_OPRA_TRADE_TYPE;
+            memcpy(data + 1, &bench_sample_trade, NMS_OPRA_TRADE_LENGTH);
+            ((struct nms_opra_trade_t *)(data + 1))->timestamp = (XC_HITIME)timestamp_ns;
+        }
+        else
+        {
+            feed_generator_write(publisher->generator, publisher->arena_offset + i, data, timestamp_ns);
+        }
+        if (length > BENCH_FRAME_HEADER_LENGTH + message_length)
+            memset(data + message_length, 0, length - BENCH_FRAME_HEADER_LENGTH - message_length);
+
+        aeron_buffer_claim_commit(&buffer_claim);
+    }
+    publisher->sequence_base = publisher->warm_up_messages;
+
+    return 0;
+}
+
+static int publish_warm_up_end(publisher_t *publisher)
+{
+    aeron_buffer_claim_t buffer_claim;
+
+    if (publisher_claim_unmeasured(publisher, BENCH_WARM_UP_END_LENGTH, &buffer_claim) < 0)
+        return -1;
+
+    bench_write_warm_up_end(buffer_claim.data, publisher->sequence_base, (uint16_t)publisher->index, publisher->warm_up_sources);
+    aeron_buffer_claim_commit(&buffer_claim);
+
+    return 0;
+}
+
+void *publisher_run(void *arg)
+{
+    publisher_t *publisher = (publisher_t *)arg;
+
+    char label[32];
+    snprintf(label, sizeof(label), "Publisher %zu", publisher->index);
+    affinity_pin_current_thread(publisher->cpu);
+    affinity_print_placement(label);
+
+    // the counters follow the thread that opens them, so each publisher opens its own
+    perf_counter_values_t perf_start;
+    if (NULL != publisher->perf_counters)
+        perf_counters_open(publisher->perf_counters);
+
+    pthread_barrier_wait(publisher->start_barrier);
+
+    if (publisher->warm_up_sources > 0)
+    {
+        bool warmed_up = publish_warm_up(publisher) == 0;
+
+        // every thread finishes its warm-up before any is measured, so none is measured against a warming one
+        pthread_barrier_wait(publisher->start_barrier);
+        if (warmed_up)
+            publish_warm_up_end(publisher);
+    }
+
+    if (NULL != publisher->perf_counters)
+        perf_counters_read(publisher->perf_counters, &perf_start);
+    int64_t cpu_start_ns = cpu_time_thread_ns();
+    publisher->start_timestamp_ns = bench_clock_ns(&publisher->clock);
+    send_schedule_start(&publisher->schedule, publisher->start_timestamp_ns);
+
+    if (NULL != publisher->capture)
+        publish_replay(publisher);
+    else if (NULL != publisher->epublication)
+        publish_exclusive(publisher);
+    else
+        publish_shared(publisher);
+
+    // a run stopped in the middle of a stall still times it, up to the stop
+    if (publisher->back_pressure.stalled)
+        publisher_on_stall_end(publisher);
+
+    publisher->end_timestamp_ns = bench_clock_ns(&publisher->clock);
+    publisher->cpu_time_ns = cpu_time_thread_ns() - cpu_start_ns;
+    if (NULL != publisher->perf_counters && perf_counters_read(publisher->perf_counters, &publisher->perf_values) == 0)
+        perf_counter_values_sub(&publisher->perf_values, &perf_start);
+    publisher_flush_progress(publisher);
+    if (publisher->export_counters)
+        publisher_update_counters(publisher);
+
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    int status = EXIT_FAILURE, opt;
+
+    const char *channel = DEFAULT_CHANNEL;
+    const char *aeron_dir = NULL;
+    bool use_embedded_driver = false;
+    aeron_threading_mode_t driver_threading_mode = AERON_THREADING_MODE_DEDICATED;
+    const char *driver_idle_strategy = NULL;
+    embedded_driver_t driver = {0};
+    uint64_t linger_ns = DEFAULT_LINGER_TIMEOUT_MS * UINT64_C(1000) * UINT64_C(1000);
+    uint64_t messages = 0;
+    uint64_t warm_up_messages = DEFAULT_NUMBER_OF_WARM_UP_MESSAGES;
+    int32_t stream_id = DEFAULT_STREAM_ID;
+    bool use_exclusive = false;
+    bool stream_id_per_thread = false;
+    bool record_send_latency = false;
+    bool record_stalls = false;
+    back_pressure_stats_t back_pressure = {0};
+    uint64_t batch_size = 1;
+    uint64_t frame_length = 0;
+    bool print_json = false;
+    bool export_counters = false;
+    bool measure_perf = false;
+    const char *clock_spec = "auto";
+    bench_clock_t bench_clock;
+    bool report_clock_read_cost = false;
+    double clock_read_ns = 0.0;
+    perf_counters_t *perf_counters = NULL;
+    perf_counter_set_t perf_set = {0};
+    const char *idle_strategy = "busy-spin";
+    feed_generator_config_t feed_config;
+    feed_generator_t generator = {0};
+    uint64_t burst_length = 0;
+    const char *capture_path = NULL;
+    capture_reader_t capture = {.fd = -1};
+    double replay_speed = 0.0;
+
+    feed_generator_config_init(&feed_config);
+    uint64_t rate = 0;
+    uint64_t thread_count = 1;
+    int cpus[AFFINITY_MAX_CPUS];
+    int cpu_count = 0;
+    int reporter_cpu = -1;
+    int numa_node = -1;
+
+    rate_reporter_t rate_reporter = {0};
+    bool show_rate_progress = false;
+
+    while ((opt = getopt(argc, argv, "hEOPvxHJKSTa:A:b:c:C:D:F:i:I:k:L:l:m:N:o:p:Q:r:R:s:t:w:X:z:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'a':
+        {
+            if ((cpu_count = affinity_parse_cpu_list(optarg, cpus, AFFINITY_MAX_CPUS)) <= 0)
+            {
+                fprintf(stderr, "malformed cpu list %s\n", optarg);
+                exit(status);
+            }
+            break;
+        }
+
+        case 'C':
+        {
+            if (affinity_parse_cpu_list(optarg, &reporter_cpu, 1) != 1)
+            {
+                fprintf(stderr, "malformed reporter cpu %s\n", optarg);
+                exit(status);
+            }
+            break;
+        }
+
+        case 'N':
+        {
+            char *end = NULL;
+            long node = strtol(optarg, &end, 10);
+            if (end == optarg || *end != '\0' || node < 0 || node > INT32_MAX)
+            {
+                fprintf(stderr, "malformed NUMA node %s\n", optarg);
+                exit(status);
+            }
+            numa_node = (int)node;
+            break;
+        }
+
+        case 'b':
+        {
+            if (aeron_parse_size64(optarg, &batch_size) < 0 || batch_size == 0)
+            {
+                fprintf(stderr, "malformed batch size %s: %s\n", optarg, aeron_errmsg());
+                exit(status);
+            }
+            break;
+        }
+
+        case 'c':
+        {
+            channel = optarg;
+            break;
+        }
+
+        case 'L':
+        {
+            if (aeron_parse_size64(optarg, &frame_length) < 0 || frame_length > INT32_MAX)
+            {
+                fprintf(stderr, "malformed message length %s: %s\n", optarg, aeron_errmsg());
+                exit(status);
+            }
+            break;
+        }
+
+        case 'A':
+        {
+            if (aeron_parse_size64(optarg, &feed_config.length) < 0)
+            {
+                fprintf(stderr, "malformed arena length %s: %s\n", optarg, aeron_errmsg());
+                exit(status);
+            }
+            break;
+        }
+
+        case 'k':
+        {
+            if (feed_generator_parse_contracts(optarg, &feed_config.contracts) < 0)
+            {
+                fprintf(stderr, "malformed number of contracts %s\n", optarg);
+                exit(status);
+            }
+            break;
+        }
+
+        case 'Q':
+        {
+            if (aeron_parse_size64(optarg, &feed_config.quotes_per_trade) < 0)
+            {
+                fprintf(stderr, "malformed quotes per trade %s: %s\n", optarg, aeron_errmsg());
+                exit(status);
+            }
+            break;
+        }
+
+        case 'R':
+        {
+            if (strcmp(optarg, "fixed") == 0)
+                burst_length = 0;
+            else if (strcmp(optarg, "poisson") == 0)
+                burst_length = 1;
+            else if (strncmp(optarg, "burst:", 6) != 0 || aeron_parse_size64(optarg + 6, &burst_length) < 0 || burst_length == 0)
+            {
+                fprintf(stderr, "malformed arrivals %s, expected fixed, poisson or burst:N\n", optarg);
+                exit(status);
+            }
+            break;
+        }
+
+        case 'z':
+        {
+            char *end = NULL;
+            feed_config.zipf_exponent = strtod(optarg, &end);
+            if (end == optarg || *end != '\0' || feed_config.zipf_exponent < 0.0)
+            {
+                fprintf(stderr, "malformed zipf exponent %s\n", optarg);
+                exit(status);
+            }
+            break;
+        }
+
+        case 'F':
+        {
+            capture_path = optarg;
+            break;
+        }
+
+        case 'X':
+        {
+            char *end = NULL;
+            replay_speed = strtod(optarg, &end);
+            if (end == optarg || *end != '\0' || replay_speed < 0.0)
+            {
+                fprintf(stderr, "malformed replay speed %s\n", optarg);
+                exit(status);
+            }
+            break;
+        }
+
+        case 'H':
+        {
+            record_send_latency = true;
+            break;
+        }
+
+        case 'T':
+        {
+            record_stalls = true;
+            break;
+        }
+
+        case 'l':
+        {
+            if (aeron_parse_duration_ns(optarg, &linger_ns) < 0)
+            {
+                fprintf(stderr, "malformed linger %s: %s\n", optarg, aeron_errmsg());
+                exit(status);
+            }
+            break;
+        }
+
+        case 'm':
+        {
+            if (aeron_parse_size64(optarg, &messages) < 0)
+            {
+                fprintf(stderr, "malformed number of messages %s: %s\n", optarg, aeron_errmsg());
+                exit(status);
+            }
+            break;
+        }
+
+        case 'w':
+        {
+            if (aeron_parse_size64(optarg, &warm_up_messages) < 0)
+            {
+                fprintf(stderr, "malformed number of warm-up messages %s: %s\n", optarg, aeron_errmsg());
+                exit(status);
+            }
+            break;
+        }
+
+        case 'P':
+        {
+#if BENCH_INSTRUMENTATION == BENCH_INSTRUMENTATION_NONE
+            fprintf(stderr, "-P ignored, built with INSTRUMENTATION=0\n");
+#else
+            show_rate_progress = true;
+#endif
+            break;
+        }
+
+        case 'J':
+        {
+            print_json = true;
+            break;
+        }
+
+        case 'E':
+        {
+            measure_perf = true;
+            break;
+        }
 
-    const char *channel = DEFAULT_CHANNEL;
-    const char *aeron_dir = NULL;
-    uint64_t linger_ns = DEFAULT_LINGER_TIMEOUT_MS * UINT64_C(1000) * UINT64_C(1000);
-    uint64_t messages = 0;
-    int32_t stream_id = DEFAULT_STREAM_ID;
-    bool use_exclusive = false;
+        case 'O':
+        {
+            report_clock_read_cost = true;
+            break;
+        }
 
-    rate_reporter_t rate_reporter;
-    bool show_rate_progress = false;
+        case 'o':
+        {
+            clock_spec = optarg;
+            break;
+        }
 
-    while ((opt = getopt(argc, argv, "hPvxc:L:l:m:p:s:")) != -1)
-    {
-        switch (opt)
+        case 'K':
         {
-        case 'c':
+#if BENCH_INSTRUMENTATION == BENCH_INSTRUMENTATION_NONE
+            fprintf(stderr, "-K ignored, built with INSTRUMENTATION=0\n");
+#else
+            export_counters = true;
+#endif
+            break;
+        }
+
+        case 'x':
         {
-            channel = optarg;
+            use_exclusive = true;
             break;
         }
 
-        case 'l':
+        case 'p':
         {
-            if (aeron_parse_duration_ns(optarg, &linger_ns) < 0)
-            {
-                fprintf(stderr, "malformed linger %s: %s\n", optarg, aeron_errmsg());
-                exit(status);
-            }
+            aeron_dir = optarg;
             break;
         }
 
-        case 'm':
+        case 'D':
         {
-            if (aeron_parse_size64(optarg, &messages) < 0)
+            if (embedded_driver_parse_threading_mode(optarg, &driver_threading_mode) < 0)
             {
-                fprintf(stderr, "malformed number of messages %s: %s\n", optarg, aeron_errmsg());
+                fprintf(stderr, "malformed threading mode %s, expected dedicated, shared-network or shared\n", optarg);
                 exit(status);
             }
+            use_embedded_driver = true;
             break;
         }
 
-        case 'P':
+        case 'I':
         {
-            show_rate_progress = true;
+            driver_idle_strategy = optarg;
             break;
         }
 
-        case 'x':
+        case 'i':
         {
-            use_exclusive = true;
+            idle_strategy = optarg;
             break;
         }
 
-        case 'p':
+        case 'r':
         {
-            aeron_dir = optarg;
+            if (send_schedule_parse_rate(optarg, &rate) < 0)
+            {
+                fprintf(stderr, "malformed rate %s\n", optarg);
+                exit(status);
+            }
             break;
         }
 
@@ -136,6 +1013,22 @@ int main(int argc, char **argv)
             break;
         }
 
+        case 'S':
+        {
+            stream_id_per_thread = true;
+            break;
+        }
+
+        case 't':
+        {
+            if (aeron_parse_size64(optarg, &thread_count) < 0 || thread_count == 0 || thread_count > BENCH_SOURCE_ID_MASK + 1)
+            {
+                fprintf(stderr, "malformed number of threads %s: %s\n", optarg, aeron_errmsg());
+                exit(status);
+            }
+            break;
+        }
+
         case 'v':
         {
             printf(
@@ -156,19 +1049,88 @@ int main(int argc, char **argv)
         }
     }
 
+    if (batch_size > 1 && !use_exclusive)
+    {
+        fprintf(stderr, "batching requires an exclusive publication (-x)\n");
+        exit(status);
+    }
+
+    if (rate > 0 && rate < thread_count)
+    {
+        fprintf(stderr, "rate %" PRIu64 " too low for %" PRIu64 " threads\n", rate, thread_count);
+        exit(status);
+    }
+
+    if (NULL != capture_path && (thread_count > 1 || rate > 0 || batch_size > 1 || frame_length > 0))
+    {
+        fprintf(stderr, "replaying a capture keeps its own framing and pacing, -t, -r, -b and -L do not apply\n");
+        exit(status);
+    }
+
+    if (burst_length > 0 && rate == 0)
+    {
+        fprintf(stderr, "arrivals other than fixed require a target rate (-r)\n");
+        exit(status);
+    }
+
     signal(SIGINT, sigint_handler);
 
-    printf("Streaming %" PRIu64 " messages to %s on stream id %" PRId32 "\n",
-           messages, channel, stream_id);
+    printf("Streaming %" PRIu64 " messages to %s on stream id %" PRId32 " from %" PRIu64 " threads\n",
+           messages, channel, stream_id, thread_count);
 
-    uint8_t *message = NULL;
     aeron_context_t *context = NULL;
     aeron_t *aeron = NULL;
-    aeron_buffer_claim_t buffer_claim;
-    aeron_async_add_exclusive_publication_t *easync = NULL;
-    aeron_exclusive_publication_t *epublication = NULL;
-    aeron_async_add_publication_t *async = NULL;
-    aeron_publication_t *publication = NULL;
+    publisher_t *publishers = NULL;
+    pthread_barrier_t start_barrier;
+    bool start_barrier_initialised = false;
+
+    // before anything is allocated, so the arena, the client conductor and the reporter follow the node
+    if (affinity_bind_current_thread_to_node(numa_node) < 0)
+    {
+        goto cleanup;
+    }
+    for (int i = 0; numa_node >= 0 && i < cpu_count; i++)
+    {
+        if (affinity_cpu_node(cpus[i]) != numa_node)
+            fprintf(stderr, "warning: cpu %d is on node %d, not node %d\n", cpus[i], affinity_cpu_node(cpus[i]), numa_node);
+    }
+    affinity_print_placement("Main");
+
+    if (NULL != capture_path)
+    {
+        if (capture_reader_open(&capture, capture_path) < 0)
+        {
+            goto cleanup;
+        }
+        printf("Replaying %s (%.04g MB) at %s\n", capture_path, (double)capture.mapping_length / (double)(1024 * 1024),
+               replay_speed > 0.0 ? "recorded pacing" : "full speed");
+    }
+    else
+    {
+        if (feed_generator_init(&generator, &feed_config) < 0)
+        {
+            fprintf(stderr, "feed_generator_init: %s\n", aeron_errmsg());
+            goto cleanup;
+        }
+        feed_generator_print_summary(&generator);
+        printf("Feed arena on node %d\n", affinity_address_node(generator.arena));
+    }
+
+    if (aeron_alloc((void **)&publishers, sizeof(publisher_t) * thread_count) < 0)
+    {
+        fprintf(stderr, "allocating publishers: %s\n", aeron_errmsg());
+        goto cleanup;
+    }
+
+    if (use_embedded_driver)
+    {
+        if (embedded_driver_start(&driver, aeron_dir, driver_threading_mode, driver_idle_strategy) < 0)
+        {
+            goto cleanup;
+        }
+        aeron_dir = embedded_driver_dir(&driver);
+    }
+
     if (aeron_context_init(&context) < 0)
     {
         fprintf(stderr, "aeron_context_init: %s\n", aeron_errmsg());
@@ -196,191 +1158,425 @@ int main(int argc, char **argv)
         goto cleanup;
     }
 
-    if (use_exclusive)
+    for (size_t t = 0; t < thread_count; t++)
     {
-        if (aeron_async_add_exclusive_publication(&easync, aeron, channel, stream_id) < 0)
+        publisher_t *publisher = &publishers[t];
+        aeron_publication_constants_t publication_constants;
+
+        publisher->index = t;
+        publisher->cpu = cpu_count > 0 ? cpus[t % cpu_count] : -1;
+        publisher->stream_id = stream_id_per_thread ? stream_id + (int32_t)t : stream_id;
+        publisher->messages = messages / thread_count + (t < messages % thread_count ? 1 : 0);
+        publisher->batch_size = batch_size;
+        publisher->frame_length = (size_t)frame_length;
+        publisher->generator = &generator;
+        publisher->arena_offset = t * ((generator.length_mask + 1) / thread_count);
+        publisher->capture = NULL != capture_path ? &capture : NULL;
+        publisher->replay_speed = replay_speed;
+        publisher->warm_up_messages = warm_up_messages / thread_count + (t < warm_up_messages % thread_count ? 1 : 0);
+        // one marker per thread, each stream of its own with -S
+        publisher->warm_up_sources = warm_up_messages > 0 ? (uint16_t)(stream_id_per_thread ? 1 : thread_count) : 0;
+        publisher->start_barrier = &start_barrier;
+        publisher->record_send_latency = record_send_latency;
+
+        if (idle_strategy_init(&publisher->idle_strategy, idle_strategy) < 0)
+        {
+            goto cleanup;
+        }
+
+        if (record_send_latency &&
+            histogram_init(&publisher->send_latency_histogram, DEFAULT_HISTOGRAM_HIGHEST_TRACKABLE_VALUE, DEFAULT_HISTOGRAM_SIGNIFICANT_FIGURES) < 0)
         {
-            fprintf(stderr, "aeron_async_add_exclusive_publication: %s\n", aeron_errmsg());
+            fprintf(stderr, "histogram_init: %s\n", aeron_errmsg());
             goto cleanup;
         }
 
-        while (NULL == epublication)
+        if (use_exclusive)
         {
-            if (aeron_async_add_exclusive_publication_poll(&epublication, easync) < 0)
+            aeron_async_add_exclusive_publication_t *easync = NULL;
+
+            if (aeron_async_add_exclusive_publication(&easync, aeron, channel, publisher->stream_id) < 0)
+            {
+                fprintf(stderr, "aeron_async_add_exclusive_publication: %s\n", aeron_errmsg());
+                goto cleanup;
+            }
+
+            while (NULL == publisher->epublication)
+            {
+                if (aeron_async_add_exclusive_publication_poll(&publisher->epublication, easync) < 0)
+                {
+                    fprintf(stderr, "aeron_async_add_exclusive_publication_poll: %s\n", aeron_errmsg());
+                    goto cleanup;
+                }
+                sched_yield();
+            }
+
+            printf("Publication channel status %" PRIu64 "\n", aeron_exclusive_publication_channel_status(publisher->epublication));
+
+            if (aeron_exclusive_publication_constants(publisher->epublication, &publication_constants) < 0)
             {
-                fprintf(stderr, "aeron_async_add_exclusive_publication_poll: %s\n", aeron_errmsg());
+                fprintf(stderr, "aeron_exclusive_publication_constants: %s\n", aeron_errmsg());
                 goto cleanup;
             }
-            sched_yield();
         }
+        else if (t > 0 && !stream_id_per_thread)
+        {
+            // all threads contend on the first thread's publication
+            if (aeron_alloc((void **)&publisher->message, BENCH_FRAME_MAX_LENGTH + (size_t)frame_length) < 0)
+            {
+                fprintf(stderr, "allocating message: %s\n", aeron_errmsg());
+                goto cleanup;
+            }
 
-        printf("Publication channel status %" PRIu64 "\n", aeron_exclusive_publication_channel_status(epublication));
-    }
-    else
-    {
-        if (aeron_alloc((void **)&message, sizeof(union option_t)) < 0)
+            publisher->publication = publishers[0].publication;
+            if (aeron_publication_constants(publisher->publication, &publication_constants) < 0)
+            {
+                fprintf(stderr, "aeron_publication_constants: %s\n", aeron_errmsg());
+                goto cleanup;
+            }
+        }
+        else
+        {
+            aeron_async_add_publication_t *async = NULL;
+
+            if (aeron_alloc((void **)&publisher->message, BENCH_FRAME_MAX_LENGTH + (size_t)frame_length) < 0)
+            {
+                fprintf(stderr, "allocating message: %s\n", aeron_errmsg());
+                goto cleanup;
+            }
+
+            publisher->owns_publication = true;
+            if (aeron_async_add_publication(&async, aeron, channel, publisher->stream_id) < 0)
+            {
+                fprintf(stderr, "aeron_async_add_publication: %s\n", aeron_errmsg());
+                goto cleanup;
+            }
+
+            while (NULL == publisher->publication)
+            {
+                if (aeron_async_add_publication_poll(&publisher->publication, async) < 0)
+                {
+                    fprintf(stderr, "aeron_async_add_publication_poll: %s\n", aeron_errmsg());
+                    goto cleanup;
+                }
+                sched_yield();
+            }
+
+            printf("Publication channel status %" PRIu64 "\n", aeron_publication_channel_status(publisher->publication));
+
+            if (aeron_publication_constants(publisher->publication, &publication_constants) < 0)
+            {
+                fprintf(stderr, "aeron_publication_constants: %s\n", aeron_errmsg());
+                goto cleanup;
+            }
+        }
+
+        publisher->max_payload_length = publication_constants.max_payload_length;
+        publisher->session_id = publication_constants.session_id;
+
+        // the driver grants a consumer half a term ahead of it unless the window is configured
+        if (back_pressure_stats_init(&publisher->back_pressure, record_stalls, (int64_t)publication_constants.term_buffer_length / 2) < 0)
         {
-            fprintf(stderr, "allocating message: %s\n", aeron_errmsg());
+            fprintf(stderr, "back_pressure_stats_init: %s\n", aeron_errmsg());
             goto cleanup;
         }
-        memset(message, 0, sizeof(union option_t));
 
-        if (aeron_async_add_publication(&async, aeron, channel, stream_id) < 0)
+        if (export_counters)
+        {
+            static const bench_counter_kind_t kinds[] = {
+                BENCH_COUNTER_MESSAGES, BENCH_COUNTER_BYTES, BENCH_COUNTER_BACK_PRESSURE, BENCH_COUNTER_CLAIMS};
+
+            if (bench_counters_init(&publisher->counters, aeron, "pub", publisher->stream_id, (int32_t)t, kinds, sizeof(kinds) / sizeof(kinds[0])) < 0)
+            {
+                goto cleanup;
+            }
+            publisher->export_counters = true;
+            printf("Publisher %zu counters %" PRId32 "-%" PRId32 "\n", t, publisher->counters.first_counter_id, publisher->counters.last_counter_id);
+        }
+
+        // a claim is limited to one MTU, an offer is fragmented up to the max message length
+        size_t max_frame_length = use_exclusive ? publication_constants.max_payload_length : publication_constants.max_message_length;
+        if (frame_length > max_frame_length)
         {
-            fprintf(stderr, "aeron_async_add_publication: %s\n", aeron_errmsg());
+            fprintf(stderr, "message length %" PRIu64 " exceeds the %s limit of %zu\n",
+                    frame_length, use_exclusive ? "claim" : "offer", max_frame_length);
             goto cleanup;
         }
 
-        while (NULL == publication)
+        if (rate > 0)
         {
-            if (aeron_async_add_publication_poll(&publication, async) < 0)
+            // every thread gets an equal share of the target rate, the first ones take the remainder
+            uint64_t thread_rate = rate / thread_count + (t < rate % thread_count ? 1 : 0);
+
+            if (burst_length > 0)
+            {
+                if (send_schedule_init_poisson(
+                        &publisher->schedule, thread_rate, DEFAULT_SEND_SCHEDULE_LENGTH, burst_length, feed_config.seed + t) < 0)
+                {
+                    fprintf(stderr, "send_schedule_init_poisson: %s\n", aeron_errmsg());
+                    goto cleanup;
+                }
+            }
+            else if (send_schedule_init_fixed_rate(&publisher->schedule, thread_rate, DEFAULT_SEND_SCHEDULE_LENGTH) < 0)
             {
-                fprintf(stderr, "aeron_async_add_publication_poll: %s\n", aeron_errmsg());
+                fprintf(stderr, "send_schedule_init_fixed_rate: %s\n", aeron_errmsg());
                 goto cleanup;
             }
-            sched_yield();
         }
+    }
 
-        printf("Publication channel status %" PRIu64 "\n", aeron_publication_channel_status(publication));
+    if (rate > 0)
+    {
+        printf("Target rate %" PRIu64 " msgs/sec\n", rate);
+    }
+    if (warm_up_messages > 0)
+    {
+        printf("Warming up with %" PRIu64 " messages\n", warm_up_messages);
     }
 
-    if (show_rate_progress)
+    if (bench_clock_init(&bench_clock, clock_spec) < 0)
+    {
+        goto cleanup;
+    }
+    if (report_clock_read_cost)
+    {
+        clock_read_ns = bench_clock_print_read_cost(&bench_clock);
+    }
+
+    if (measure_perf)
     {
-        if (rate_reporter_start(&rate_reporter, print_rate_report) < 0)
+        if (aeron_alloc((void **)&perf_counters, sizeof(perf_counters_t) * thread_count) < 0)
         {
-            fprintf(stderr, "rate_reporter_start: %s\n", aeron_errmsg());
+            fprintf(stderr, "allocating perf counters: %s\n", aeron_errmsg());
             goto cleanup;
         }
+
+        for (size_t t = 0; t < thread_count; t++)
+            publishers[t].perf_counters = &perf_counters[t];
+        perf_set.counters = perf_counters;
+        perf_set.count = thread_count;
     }
 
-    struct nms_opra_trade_t trade = {
-        .symbol = "AAPL",
-        .condition = 'a',
-        .exchange = 'A',
-        .strike_price = 123456,
-        .premium_price = 987654,
-        .volume = 111,
-        .expiration = {'T', 23, 18}, // 2023-08-18 Put
-    };
-
-    struct nms_opra_quote_t quote = {
-        .symbol = "AAPL",
-        .condition = 'a',
-        .bid_price = 123456,
-        .ask_price = 987654,
-        .bid_size = 111,
-        .ask_size = 999,
-        .bid_exchange = 'A',
-        .ask_exchange = 'Z',
-        .expiration = {'L', 23, 18}, // 2023-12-18 Call
-    };
-
-    uint64_t back_pressure_count = 0, message_sent_count = 0;
-    int64_t start_timestamp_ns, duration_ns;
-
-    start_timestamp_ns = aeron_nano_clock();
-    int message_length = 0;
-    if (use_exclusive)
+    if (show_rate_progress)
     {
-        for (uint64_t i = 0; (messages == 0 || i < messages) && is_running();)
+        if (measure_perf)
+            rate_reporter_set_on_interval(&rate_reporter, perf_counter_set_on_interval, &perf_set);
+
+        if (rate_reporter_start_writers(&rate_reporter, print_rate_report, thread_count) < 0)
         {
-            // +1 is the type
-            message_length = (i % 2 == 0) ? sizeof(struct nms_opra_trade_t) + 1 : sizeof(struct nms_opra_quote_t) + 1;
-            int64_t result = aeron_exclusive_publication_try_claim(
-                epublication,
-                message_length,
-                &buffer_claim);
+            fprintf(stderr, "rate_reporter_start: %s\n", aeron_errmsg());
+            goto cleanup;
+        }
 
-            if (result == AERON_PUBLICATION_ERROR)
-            {
-                fprintf(stderr, "aeron_exclusive_publication_try_claim: %s\n", aeron_errmsg());
-                break;
-            }
-            else if (result < 0)
+        for (size_t t = 0; t < thread_count; t++)
+            publishers[t].rate_reporter_writer = rate_reporter_writer(&rate_reporter, t);
+
+        if (reporter_cpu >= 0)
+        {
+            if (affinity_pin_thread(rate_reporter.runner.thread, reporter_cpu) < 0)
             {
-                back_pressure_count++;
-                aeron_idle_strategy_busy_spinning_idle(NULL, 0);
+                goto cleanup;
             }
-            else
-            {
-                xuint8 shift = i % 26;
-                if (i % 2 == 0)
-                {
-                    trade.timestamp = aeron_nano_clock();
-                    trade.condition = 'a' + shift;
-                    trade.exchange = 'A' + shift;
-                    trade.volume = 100 + shift;
-                    buffer_claim.data[0] = 't';
-                    *((struct nms_opra_trade_t *)&buffer_claim.data[1]) = trade;
-                }
-                else
-                {
-                    quote.timestamp = aeron_nano_clock();
-                    quote.condition = 'a' + shift;
-                    quote.ask_exchange = 'A' + shift;
-                    quote.bid_exchange = 'Z' - shift;
-                    quote.ask_size = 201 + shift;
-                    quote.bid_size = 199 - shift;
-                    buffer_claim.data[0] = 'q';
-                    *((struct nms_opra_quote_t *)&buffer_claim.data[1]) = quote;
-                }
-                aeron_buffer_claim_commit(&buffer_claim);
-                if (show_rate_progress)
-                    rate_reporter_on_message(&rate_reporter, message_length);
+            printf("Rate reporter: cpu %d node %d\n", reporter_cpu, affinity_cpu_node(reporter_cpu));
+        }
+    }
 
-                message_sent_count++;
-                i++;
-            }
+    if (pthread_barrier_init(&start_barrier, NULL, (unsigned)thread_count) != 0)
+    {
+        fprintf(stderr, "pthread_barrier_init failed\n");
+        goto cleanup;
+    }
+    start_barrier_initialised = true;
+
+    int64_t process_cpu_start_ns = cpu_time_process_ns();
+    for (size_t t = 0; t < thread_count; t++)
+    {
+        publishers[t].clock = bench_clock;
+        if (pthread_create(&publishers[t].thread, NULL, publisher_run, &publishers[t]) != 0)
+        {
+            fprintf(stderr, "pthread_create failed for publisher %zu\n", t);
+            // threads already waiting on the barrier can never be released
+            exit(status);
         }
     }
-    else
+
+    for (size_t t = 0; t < thread_count; t++)
+    {
+        pthread_join(publishers[t].thread, NULL);
+    }
+    int64_t process_cpu_ns = cpu_time_process_ns() - process_cpu_start_ns;
+
+    printf("Done sending.\n");
+
+    if (show_rate_progress)
+    {
+        rate_reporter_halt(&rate_reporter);
+    }
+
+    uint64_t back_pressure_count = 0, message_sent_count = 0, bytes_sent_count = 0, claim_count = 0, skipped_record_count = 0;
+    uint64_t skipped_warm_up_record_count = 0;
+    int64_t start_timestamp_ns = INT64_MAX, end_timestamp_ns = 0, max_schedule_lag_ns = 0, cpu_time_ns = 0;
+    perf_counter_values_t perf_values = {0};
+
+    if (back_pressure_stats_init(&back_pressure, record_stalls, publishers[0].back_pressure.window_length) < 0)
+    {
+        fprintf(stderr, "back_pressure_stats_init: %s\n", aeron_errmsg());
+        goto cleanup;
+    }
+
+    for (size_t t = 0; t < thread_count; t++)
     {
-        for (uint64_t i = 0; (messages == 0 || i < messages) && is_running(); i++)
+        publisher_t *publisher = &publishers[t];
+        int64_t thread_duration_ns = publisher->end_timestamp_ns - publisher->start_timestamp_ns;
+
+        if (thread_count > 1)
         {
-            if (i % 2 == 0)
+            printf(
+                "Publisher %zu cpu %d stream %" PRId32 " session %" PRId32 ": %" PRIu64 " messages, %.04g msgs/sec, back pressure ratio %g, "
+                "cpu time %.3f ms (%.2f cores)\n",
+                t,
+                publisher->cpu,
+                publisher->stream_id,
+                publisher->session_id,
+                publisher->message_sent_count,
+                (double)publisher->message_sent_count * (double)(1000 * 1000 * 1000) / (double)thread_duration_ns,
+                (double)publisher->back_pressure_count / (double)publisher->message_sent_count,
+                (double)publisher->cpu_time_ns / (1000.0 * 1000.0),
+                cpu_time_cores(publisher->cpu_time_ns, thread_duration_ns));
+
+            if (record_send_latency)
             {
-                message_length = sizeof(struct nms_opra_trade_t);
-                trade.timestamp = aeron_nano_clock();
-                *((struct nms_opra_trade_t *)message) = trade;
+                char label[64];
+                snprintf(label, sizeof(label), "Publisher %zu send", t);
+                print_latency_report(label, &publisher->send_latency_histogram);
             }
-            else
+
+            if (measure_perf)
             {
-                message_length = sizeof(struct nms_opra_quote_t);
-                quote.timestamp = aeron_nano_clock();
-                *((struct nms_opra_quote_t *)message) = quote;
+                char label[64];
+                snprintf(label, sizeof(label), "Publisher %zu perf", t);
+                perf_counters_print(label, &publisher->perf_values, publisher->message_sent_count);
             }
-            while (aeron_publication_offer(publication, message, message_length, NULL, NULL) < 0)
+
+            if (record_stalls)
             {
-                ++back_pressure_count;
-                if (!is_running())
-                    break;
-                aeron_idle_strategy_busy_spinning_idle(NULL, 0);
+                char label[64];
+                snprintf(label, sizeof(label), "Publisher %zu back pressure", t);
+                back_pressure_stats_print(label, &publisher->back_pressure);
             }
+        }
 
-            if (show_rate_progress)
-                rate_reporter_on_message(&rate_reporter, message_length);
+        perf_counter_values_add(&perf_values, &publisher->perf_values);
+        back_pressure_stats_add(&back_pressure, &publisher->back_pressure);
+        bench_clock_add_checks(&bench_clock, &publisher->clock);
 
-            message_sent_count++;
-        }
+        back_pressure_count += publisher->back_pressure_count;
+        message_sent_count += publisher->message_sent_count;
+        bytes_sent_count += publisher->bytes_sent_count;
+        claim_count += publisher->claim_count;
+        skipped_record_count += publisher->skipped_record_count;
+        skipped_warm_up_record_count += publisher->skipped_warm_up_record_count;
+        if (publisher->start_timestamp_ns < start_timestamp_ns)
+            start_timestamp_ns = publisher->start_timestamp_ns;
+        if (publisher->end_timestamp_ns > end_timestamp_ns)
+            end_timestamp_ns = publisher->end_timestamp_ns;
+        if (publisher->max_schedule_lag_ns > max_schedule_lag_ns)
+            max_schedule_lag_ns = publisher->max_schedule_lag_ns;
+        cpu_time_ns += publisher->cpu_time_ns;
     }
-    duration_ns = aeron_nano_clock() - start_timestamp_ns;
 
-    printf("Done sending.\n");
+    int64_t duration_ns = end_timestamp_ns - start_timestamp_ns;
 
-    if (show_rate_progress)
+    if (thread_count > 1)
     {
-        rate_reporter_halt(&rate_reporter);
+        printf("%" PRIu64 " threads on %s\n", thread_count,
+               use_exclusive ? "exclusive publications" : stream_id_per_thread ? "one publication per stream" : "one shared publication");
+    }
+
+    if (record_send_latency)
+    {
+        // fold every thread into the first thread's histogram, which is not used after this
+        for (size_t t = 1; t < thread_count; t++)
+            histogram_add(&publishers[0].send_latency_histogram, &publishers[t].send_latency_histogram);
+        print_latency_report("Send", &publishers[0].send_latency_histogram);
     }
 
-    double avg_message_length = (double)sizeof(struct nms_opra_trade_t) + sizeof(struct nms_opra_quote_t) / 2.0;
     printf("Publisher back pressure ratio %g\n", (double)back_pressure_count / (double)message_sent_count);
+    back_pressure_stats_print("Back pressure", &back_pressure);
+    printf("CPU: publisher threads %.3f ms (%.2f cores) idling with %s, process %.3f ms (%.2f cores)\n",
+           (double)cpu_time_ns / (1000.0 * 1000.0),
+           cpu_time_cores(cpu_time_ns, duration_ns),
+           idle_strategy,
+           (double)process_cpu_ns / (1000.0 * 1000.0),
+           cpu_time_cores(process_cpu_ns, duration_ns));
+    if (rate > 0)
+    {
+        printf("Target rate %" PRIu64 " msgs/sec, max schedule lag %.3f us\n",
+               rate, (double)max_schedule_lag_ns / 1000.0);
+    }
+    if (NULL != capture_path)
+    {
+        printf("Replayed %" PRIu64 " records", claim_count);
+        if (replay_speed > 0.0)
+            printf(" at %gx recorded pacing, max schedule lag %.3f us", replay_speed, (double)max_schedule_lag_ns / 1000.0);
+        printf(", skipped %" PRIu64 " records not fitting one claim and %" PRIu64 " recorded warm-up frames\n",
+               skipped_record_count, skipped_warm_up_record_count);
+    }
+    if (measure_perf)
+    {
+        perf_counters_print("Perf", &perf_values, message_sent_count);
+    }
+    bench_clock_print_report(&bench_clock);
+    if (use_exclusive)
+    {
+        printf("Claims %" PRIu64 ", %.04g messages per claim\n",
+               claim_count, claim_count > 0 ? (double)message_sent_count / (double)claim_count : 0.0);
+    }
     printf(
         "Total: %" PRId64 "ms, %.04g msgs/sec, %.04g bytes/sec, totals %" PRIu64 " messages %.04g MB payloads\n",
         duration_ns / (1000 * 1000),
-        ((double)messages * (double)(1000 * 1000 * 1000) / (double)duration_ns),
-        ((double)(messages * avg_message_length) * (double)(1000 * 1000 * 1000) / (double)duration_ns),
-        messages,
-        (double)messages * avg_message_length / (double)(1024 * 1024));
+        ((double)message_sent_count * (double)(1000 * 1000 * 1000) / (double)duration_ns),
+        ((double)bytes_sent_count * (double)(1000 * 1000 * 1000) / (double)duration_ns),
+        message_sent_count,
+        (double)bytes_sent_count / (double)(1024 * 1024));
+
+    if (print_json)
+    {
+        json_report_t report;
+        json_report_begin(&report, stdout, "pub");
+        json_report_string(&report, "channel", channel);
+        json_report_int(&report, "stream_id", stream_id);
+        json_report_string(&report, "publication", use_exclusive ? "exclusive" : "shared");
+        json_report_uint(&report, "threads", thread_count);
+        json_report_uint(&report, "batch", batch_size);
+        json_report_uint(&report, "message_length", frame_length);
+        json_report_uint(&report, "rate", rate);
+        json_report_uint(&report, "warm_up_messages", warm_up_messages);
+        json_report_int(&report, "duration_ns", duration_ns);
+        json_report_uint(&report, "messages", message_sent_count);
+        json_report_uint(&report, "bytes", bytes_sent_count);
+        json_report_uint(&report, "claims", claim_count);
+        json_report_double(&report, "msgs_per_sec", (double)message_sent_count * (double)(1000 * 1000 * 1000) / (double)duration_ns);
+        json_report_double(&report, "bytes_per_sec", (double)bytes_sent_count * (double)(1000 * 1000 * 1000) / (double)duration_ns);
+        json_report_uint(&report, "back_pressure_count", back_pressure_count);
+        json_report_double(&report, "back_pressure_ratio", (double)back_pressure_count / (double)message_sent_count);
+        json_report_back_pressure(&report, &back_pressure);
+        json_report_int(&report, "max_schedule_lag_ns", max_schedule_lag_ns);
+        json_report_string(&report, "idle", idle_strategy);
+        json_report_string(&report, "instrumentation", BENCH_INSTRUMENTATION_NAME);
+        json_report_string(&report, "clock", bench_clock.name);
+        json_report_int(&report, "clock_max_drift_ns", bench_clock.max_drift_ns);
+        if (report_clock_read_cost)
+            json_report_double(&report, "clock_read_ns", clock_read_ns);
+        json_report_int(&report, "cpu_time_ns", cpu_time_ns);
+        json_report_double(&report, "cpu_cores", cpu_time_cores(cpu_time_ns, duration_ns));
+        json_report_int(&report, "process_cpu_time_ns", process_cpu_ns);
+        if (record_send_latency)
+            json_report_histogram(&report, "send_latency", &publishers[0].send_latency_histogram);
+        if (measure_perf)
+            json_report_perf_counters(&report, "perf", &perf_values, message_sent_count);
+        json_report_end(&report);
+    }
 
     if (linger_ns > 0)
     {
@@ -391,12 +1587,31 @@ int main(int argc, char **argv)
     status = EXIT_SUCCESS;
 
 cleanup:
-    aeron_exclusive_publication_close(epublication, NULL, NULL);
-    aeron_publication_close(publication, NULL, NULL);
+    if (start_barrier_initialised)
+        pthread_barrier_destroy(&start_barrier);
+
+    for (size_t t = 0; NULL != publishers && t < thread_count; t++)
+    {
+        aeron_exclusive_publication_close(publishers[t].epublication, NULL, NULL);
+        if (publishers[t].owns_publication)
+            aeron_publication_close(publishers[t].publication, NULL, NULL);
+        histogram_close(&publishers[t].send_latency_histogram);
+        idle_strategy_close(&publishers[t].idle_strategy);
+        bench_counters_close(&publishers[t].counters);
+        back_pressure_stats_close(&publishers[t].back_pressure);
+        if (NULL != perf_counters)
+            perf_counters_close(&perf_counters[t]);
+        send_schedule_close(&publishers[t].schedule);
+        aeron_free(publishers[t].message);
+    }
     aeron_close(aeron);
     aeron_context_close(context);
-    if (use_exclusive)
-        aeron_free(message);
+    embedded_driver_close(&driver);
+    aeron_free(publishers);
+    aeron_free(perf_counters);
+    back_pressure_stats_close(&back_pressure);
+    feed_generator_close(&generator);
+    capture_reader_close(&capture);
 
     return status;
 }
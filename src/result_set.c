@@ -0,0 +1,292 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include <aeronc.h>
+#include <aeron_alloc.h>
+
+#include "result_set.h"
+
+#define RESULT_SET_MAX_LINE_LENGTH (64 * 1024)
+#define RESULT_SET_MAX_LINE_VALUES (256)
+#define RESULT_SET_MAX_DEPTH (4)
+
+typedef struct result_line_stct
+{
+    char point[RESULT_SET_MAX_POINT_LENGTH];
+    char strings[RESULT_SET_MAX_POINT_LENGTH];
+    size_t value_count;
+    struct
+    {
+        char metric[RESULT_SET_MAX_METRIC_LENGTH];
+        double value;
+    } values[RESULT_SET_MAX_LINE_VALUES];
+} result_line_t;
+
+static const char *result_set_skip_whitespace(const char *c)
+{
+    while (*c == ' ' || *c == '\t' || *c == '\r' || *c == '\n')
+        c++;
+    return c;
+}
+
+/* Copies the string at c into out, truncated to out_length, and returns the position after the closing quote. */
+static const char *result_set_parse_string(const char *c, char *out, size_t out_length)
+{
+    size_t length = 0;
+
+    if (*c++ != '"')
+        return NULL;
+
+    for (; *c != '"'; c++)
+    {
+        if (*c == '\0')
+            return NULL;
+        if (*c == '\\' && *++c == '\0')
+            return NULL;
+        if (length + 1 < out_length)
+            out[length++] = *c;
+    }
+    out[length] = '\0';
+
+    return c + 1;
+}
+
+/* Returns the position after the value at c, which may be an object, an array, a string or a scalar. */
+static const char *result_set_skip_value(const char *c)
+{
+    int depth = 0;
+
+    while (*c != '\0')
+    {
+        if (*c == '"')
+        {
+            char ignored[1];
+            if ((c = result_set_parse_string(c, ignored, sizeof(ignored))) == NULL)
+                return NULL;
+            if (depth == 0)
+                return c;
+            continue;
+        }
+
+        if (*c == '{' || *c == '[')
+        {
+            depth++;
+        }
+        else if (*c == '}' || *c == ']')
+        {
+            if (depth == 0)
+                return c;
+            if (--depth == 0)
+                return c + 1;
+        }
+        else if (depth == 0 && (*c == ',' || *c == ' ' || *c == '\n'))
+        {
+            return c;
+        }
+        c++;
+    }
+
+    return depth == 0 ? c : NULL;
+}
+
+static void result_set_append(char *buffer, size_t buffer_length, const char *a, const char *b)
+{
+    size_t length = strlen(buffer);
+    snprintf(buffer + length, buffer_length - length, "%s%s=%s", length > 0 ? " " : "", a, b);
+}
+
+static const char *result_set_parse_object(result_line_t *line, const char *c, const char *prefix, int depth)
+{
+    if (depth > RESULT_SET_MAX_DEPTH || *c++ != '{')
+        return NULL;
+
+    for (c = result_set_skip_whitespace(c); *c != '}'; c = result_set_skip_whitespace(c))
+    {
+        char key[RESULT_SET_MAX_METRIC_LENGTH], path[RESULT_SET_MAX_METRIC_LENGTH];
+
+        if ((c = result_set_parse_string(c, key, sizeof(key))) == NULL)
+            return NULL;
+        c = result_set_skip_whitespace(c);
+        if (*c++ != ':')
+            return NULL;
+        c = result_set_skip_whitespace(c);
+
+        int path_length = prefix[0] != '\0' ?
+            snprintf(path, sizeof(path), "%s.%s", prefix, key) : snprintf(path, sizeof(path), "%s", key);
+        if (path_length < 0 || (size_t)path_length >= sizeof(path))
+            return NULL;
+
+        if (depth == 0 && strcmp(key, "point") == 0)
+        {
+            const char *start = c;
+            if ((c = result_set_skip_value(c)) == NULL)
+                return NULL;
+            snprintf(line->point, sizeof(line->point), "%.*s", (int)(c - start), start);
+        }
+        else if (*c == '{')
+        {
+            if ((c = result_set_parse_object(line, c, path, depth + 1)) == NULL)
+                return NULL;
+        }
+        else if (*c == '"')
+        {
+            char value[RESULT_SET_MAX_POINT_LENGTH];
+            if ((c = result_set_parse_string(c, value, sizeof(value))) == NULL)
+                return NULL;
+            if (depth == 0)
+                result_set_append(line->strings, sizeof(line->strings), key, value);
+        }
+        else
+        {
+            char *end = NULL;
+            double value = strtod(c, &end);
+            if (end != c && line->value_count < RESULT_SET_MAX_LINE_VALUES)
+            {
+                snprintf(line->values[line->value_count].metric, RESULT_SET_MAX_METRIC_LENGTH, "%s", path);
+                line->values[line->value_count].value = value;
+                line->value_count++;
+                c = end;
+            }
+            else if ((c = result_set_skip_value(c)) == NULL) // null, true, false and arrays are not metrics
+            {
+                return NULL;
+            }
+        }
+
+        c = result_set_skip_whitespace(c);
+        if (*c == ',')
+            c++;
+        else if (*c != '}')
+            return NULL;
+    }
+
+    return c + 1;
+}
+
+static result_series_t *result_set_series(result_set_t *set, const char *point, const char *metric)
+{
+    result_series_t *series = (result_series_t *)result_set_find(set, point, metric);
+    if (NULL != series)
+        return series;
+
+    if (set->count == set->capacity)
+    {
+        size_t capacity = set->capacity > 0 ? set->capacity * 2 : 64;
+        if (aeron_reallocf((void **)&set->series, sizeof(result_series_t) * capacity) < 0)
+            return NULL;
+        set->capacity = capacity;
+    }
+
+    series = &set->series[set->count++];
+    memset(series, 0, sizeof(result_series_t));
+    snprintf(series->point, sizeof(series->point), "%s", point);
+    snprintf(series->metric, sizeof(series->metric), "%s", metric);
+
+    return series;
+}
+
+int result_set_load(result_set_t *set, const char *path)
+{
+    int result = -1;
+    FILE *file = NULL;
+    char *buffer = NULL;
+    result_line_t *line = NULL;
+    uint64_t line_number = 0;
+
+    memset(set, 0, sizeof(result_set_t));
+
+    if ((file = fopen(path, "r")) == NULL)
+    {
+        fprintf(stderr, "result_set_load: %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    if (aeron_alloc((void **)&buffer, RESULT_SET_MAX_LINE_LENGTH) < 0 ||
+        aeron_alloc((void **)&line, sizeof(result_line_t)) < 0)
+    {
+        fprintf(stderr, "result_set_load: %s\n", aeron_errmsg());
+        goto cleanup;
+    }
+
+    while (fgets(buffer, RESULT_SET_MAX_LINE_LENGTH, file) != NULL)
+    {
+        const char *c = result_set_skip_whitespace(buffer);
+        line_number++;
+
+        // anything that is not a JSON object, like the rest of a bench's output, is skipped
+        if (*c != '{')
+            continue;
+
+        memset(line, 0, sizeof(result_line_t));
+        if (result_set_parse_object(line, c, "", 0) == NULL)
+        {
+            fprintf(stderr, "result_set_load: %s:%" PRIu64 ": malformed result, skipped\n", path, line_number);
+            continue;
+        }
+
+        const char *point = line->point[0] != '\0' ? line->point : line->strings;
+        for (size_t i = 0; i < line->value_count; i++)
+        {
+            result_series_t *series = result_set_series(set, point, line->values[i].metric);
+            if (NULL == series)
+            {
+                fprintf(stderr, "result_set_load: %s\n", aeron_errmsg());
+                goto cleanup;
+            }
+
+            if (series->count == series->capacity)
+            {
+                size_t capacity = series->capacity > 0 ? series->capacity * 2 : 8;
+                if (aeron_reallocf((void **)&series->samples, sizeof(double) * capacity) < 0)
+                {
+                    fprintf(stderr, "result_set_load: %s\n", aeron_errmsg());
+                    goto cleanup;
+                }
+                series->capacity = capacity;
+            }
+            series->samples[series->count++] = line->values[i].value;
+        }
+        set->runs++;
+    }
+
+    if (ferror(file))
+    {
+        fprintf(stderr, "result_set_load: %s: %s\n", path, strerror(errno));
+        goto cleanup;
+    }
+
+    result = 0;
+
+cleanup:
+    aeron_free(line);
+    aeron_free(buffer);
+    fclose(file);
+    if (result < 0)
+        result_set_close(set);
+
+    return result;
+}
+
+void result_set_close(result_set_t *set)
+{
+    for (size_t i = 0; i < set->count; i++)
+        aeron_free(set->series[i].samples);
+    aeron_free(set->series);
+    set->series = NULL;
+    set->count = set->capacity = 0;
+}
+
+const result_series_t *result_set_find(const result_set_t *set, const char *point, const char *metric)
+{
+    for (size_t i = 0; i < set->count; i++)
+    {
+        if (strcmp(set->series[i].metric, metric) == 0 && strcmp(set->series[i].point, point) == 0)
+            return &set->series[i];
+    }
+
+    return NULL;
+}
@@ -0,0 +1,38 @@
+#ifndef RESULT_SET_H
+#define RESULT_SET_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define RESULT_SET_MAX_POINT_LENGTH (512)
+#define RESULT_SET_MAX_METRIC_LENGTH (64)
+
+/* The samples of one metric at one point, one sample per run. */
+typedef struct result_series_stct
+{
+    char point[RESULT_SET_MAX_POINT_LENGTH];
+    char metric[RESULT_SET_MAX_METRIC_LENGTH];
+    double *samples;
+    size_t count;
+    size_t capacity;
+} result_series_t;
+
+/*
+ * Results loaded from JSON lines, one run per line, as printed by pub and sub -J or collected by
+ * scripts/sweep.sh. Runs with the same "point" object, or without one the same top level strings (role,
+ * channel, publication), are repeats of one configuration. Every numeric value outside the point is a
+ * metric, nested keys are joined with a dot, e.g. sub.latency_p99_ns.
+ */
+typedef struct result_set_stct
+{
+    result_series_t *series;
+    size_t count;
+    size_t capacity;
+    uint64_t runs;
+} result_set_t;
+
+int result_set_load(result_set_t *set, const char *path);
+void result_set_close(result_set_t *set);
+const result_series_t *result_set_find(const result_set_t *set, const char *point, const char *metric);
+
+#endif
@@ -17,6 +17,8 @@
 #include <stdio.h>
 #include <inttypes.h>
 
+#include <aeron_alloc.h>
+
 #include "sample_util.h"
 
 void print_available_image(void __attribute__((unused)) * clientd, aeron_subscription_t *subscription, aeron_image_t *image)
@@ -71,12 +73,19 @@ void print_rate_report(uint64_t duration_ns, double mps, double bps, uint64_t to
 int rate_reporter_do_work(void *state)
 {
     rate_reporter_t *reporter = (rate_reporter_t *)state;
-    uint64_t current_total_bytes, current_total_messages;
+    uint64_t current_total_bytes = 0, current_total_messages = 0;
     int64_t current_timestamp_ns, duration_ns;
     double mps, bps;
 
-    AERON_GET_VOLATILE(current_total_bytes, reporter->polling_fields.total_bytes);
-    AERON_GET_VOLATILE(current_total_messages, reporter->polling_fields.total_messages);
+    for (size_t i = 0; i < reporter->writer_count; i++)
+    {
+        uint64_t writer_total_bytes, writer_total_messages;
+
+        AERON_GET_VOLATILE(writer_total_bytes, reporter->writers[i].total_bytes);
+        AERON_GET_VOLATILE(writer_total_messages, reporter->writers[i].total_messages);
+        current_total_bytes += writer_total_bytes;
+        current_total_messages += writer_total_messages;
+    }
     current_timestamp_ns = aeron_nano_clock();
     duration_ns = current_timestamp_ns - reporter->last_timestamp_ns;
     mps = ((double)(current_total_messages - reporter->last_total_messages) *
@@ -87,6 +96,8 @@ int rate_reporter_do_work(void *state)
           (double)duration_ns;
 
     reporter->on_report(duration_ns, mps, bps, current_total_messages, current_total_bytes);
+    if (NULL != reporter->on_interval)
+        reporter->on_interval(reporter->on_interval_clientd, duration_ns, current_total_messages - reporter->last_total_messages);
 
     reporter->last_total_bytes = current_total_bytes;
     reporter->last_total_messages = current_total_messages;
@@ -95,15 +106,21 @@ int rate_reporter_do_work(void *state)
     return 0;
 }
 
-int rate_reporter_start(rate_reporter_t *reporter, on_rate_report_t on_report)
+static int rate_reporter_start_agent(rate_reporter_t *reporter, on_rate_report_t on_report)
 {
     reporter->idle_duration_ns = UINT64_C(1000) * UINT64_C(1000) * UINT64_C(1000);
     reporter->on_report = on_report;
     reporter->last_total_bytes = 0;
     reporter->last_total_messages = 0;
     reporter->last_timestamp_ns = aeron_nano_clock();
-    reporter->polling_fields.total_bytes = 0;
-    reporter->polling_fields.total_messages = 0;
+    for (size_t i = 0; i < reporter->writer_count; i++)
+    {
+        reporter->writers[i].total_bytes = 0;
+        reporter->writers[i].total_messages = 0;
+        reporter->writers[i].local_bytes = 0;
+        reporter->writers[i].local_messages = 0;
+        reporter->writers[i].unpublished = 0;
+    }
 
     if (aeron_agent_init(
             &reporter->runner,
@@ -127,13 +144,46 @@ int rate_reporter_start(rate_reporter_t *reporter, on_rate_report_t on_report)
     return 0;
 }
 
+int rate_reporter_start(rate_reporter_t *reporter, on_rate_report_t on_report)
+{
+    reporter->writer_count = 1;
+    reporter->writers = &reporter->polling_fields;
+
+    return rate_reporter_start_agent(reporter, on_report);
+}
+
+int rate_reporter_start_writers(rate_reporter_t *reporter, on_rate_report_t on_report, size_t writer_count)
+{
+    reporter->writer_count = writer_count;
+    reporter->writers = NULL;
+    if (aeron_alloc((void **)&reporter->writers, sizeof(rate_reporter_writer_t) * writer_count) < 0)
+    {
+        return -1;
+    }
+
+    return rate_reporter_start_agent(reporter, on_report);
+}
+
 int rate_reporter_halt(rate_reporter_t *reporter)
 {
     aeron_agent_stop(&reporter->runner);
     aeron_agent_close(&reporter->runner);
 
+    if (reporter->writers != &reporter->polling_fields)
+    {
+        aeron_free(reporter->writers);
+    }
+    reporter->writers = NULL;
+
     return 0;
 }
 
+extern void rate_reporter_set_on_interval(rate_reporter_t *reporter, on_rate_interval_t on_interval, void *clientd);
+extern void rate_reporter_writer_publish(rate_reporter_writer_t *writer);
+extern void rate_reporter_writer_flush(rate_reporter_writer_t *writer);
+extern void rate_reporter_flush(rate_reporter_t *reporter);
 extern void rate_reporter_poll_handler(void *clientd, const uint8_t *buffer, size_t length, aeron_header_t *header);
 extern void rate_reporter_on_message(rate_reporter_t *reporter, size_t length);
+extern void rate_reporter_on_messages(rate_reporter_t *reporter, uint64_t count, size_t length);
+extern rate_reporter_writer_t *rate_reporter_writer(rate_reporter_t *reporter, size_t index);
+extern void rate_reporter_writer_on_messages(rate_reporter_writer_t *writer, uint64_t count, size_t length);
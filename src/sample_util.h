@@ -21,6 +21,8 @@
 #include <aeron_agent.h>
 #include <util/aeron_bitutil.h>
 
+#include "instrumentation.h"
+
 void print_available_image(void *clientd, aeron_subscription_t *subscription, aeron_image_t *image);
 void print_unavailable_image(void *clientd, aeron_subscription_t *subscription, aeron_image_t *image);
 
@@ -29,40 +31,113 @@ void print_rate_report(uint64_t duration_ns, double mps, double bps, uint64_t to
 typedef void (*on_rate_report_t)(
     uint64_t duration_ns, double mps, double bps, uint64_t total_messages, uint64_t total_bytes);
 
+/* Called on the reporter thread right after each report, with the messages of that interval. */
+typedef void (*on_rate_interval_t)(void *clientd, int64_t duration_ns, uint64_t messages);
+
+/*
+ * Totals of one writer thread. The local fields are only touched by the writer, with plain stores; the
+ * volatile ones are what the reporter reads and are only written when the writer publishes.
+ */
+typedef struct rate_reporter_writer_stct
+{
+    uint8_t pre_pad[AERON_CACHE_LINE_LENGTH * 2];
+    volatile uint64_t total_bytes;
+    volatile uint64_t total_messages;
+    uint64_t local_bytes;
+    uint64_t local_messages;
+    uint64_t unpublished;
+    uint8_t post_pad[AERON_CACHE_LINE_LENGTH * 2];
+} rate_reporter_writer_t;
+
 typedef struct rate_reporter_stct
 {
     aeron_agent_runner_t runner;
     uint64_t idle_duration_ns;
     on_rate_report_t on_report;
+    on_rate_interval_t on_interval;
+    void *on_interval_clientd;
 
     uint64_t last_total_bytes;
     uint64_t last_total_messages;
     int64_t last_timestamp_ns;
 
-    struct polling_elements_stct
-    {
-        uint8_t pre_pad[AERON_CACHE_LINE_LENGTH * 2];
-        volatile uint64_t total_bytes;
-        volatile uint64_t total_messages;
-        uint8_t post_pad[AERON_CACHE_LINE_LENGTH * 2];
-    } polling_fields;
+    size_t writer_count;
+    rate_reporter_writer_t *writers;
+    rate_reporter_writer_t polling_fields;
 } rate_reporter_t;
 
 int rate_reporter_start(rate_reporter_t *reporter, on_rate_report_t on_report);
+int rate_reporter_start_writers(rate_reporter_t *reporter, on_rate_report_t on_report, size_t writer_count);
 int rate_reporter_halt(rate_reporter_t *reporter);
 
+/* Set before the reporter is started, on a reporter that was zero initialised. */
+inline void rate_reporter_set_on_interval(rate_reporter_t *reporter, on_rate_interval_t on_interval, void *clientd)
+{
+    reporter->on_interval = on_interval;
+    reporter->on_interval_clientd = clientd;
+}
+
+/* Each writer thread owns one padded slot, the reporter sums them. */
+inline rate_reporter_writer_t *rate_reporter_writer(rate_reporter_t *reporter, size_t index)
+{
+    return &reporter->writers[index];
+}
+
+inline void rate_reporter_writer_publish(rate_reporter_writer_t *writer)
+{
+    AERON_PUT_ORDERED(writer->total_bytes, writer->local_bytes);
+    AERON_PUT_ORDERED(writer->total_messages, writer->local_messages);
+    writer->unpublished = 0;
+}
+
+inline void rate_reporter_writer_on_messages(rate_reporter_writer_t *writer, uint64_t count, size_t length)
+{
+#if BENCH_INSTRUMENTATION == BENCH_INSTRUMENTATION_BATCHED
+    writer->local_bytes += length;
+    writer->local_messages += count;
+    if (++writer->unpublished >= BENCH_INSTRUMENTATION_BATCH)
+        rate_reporter_writer_publish(writer);
+#elif BENCH_INSTRUMENTATION == BENCH_INSTRUMENTATION_ORDERED
+    AERON_PUT_ORDERED(writer->total_bytes, writer->total_bytes + length);
+    AERON_PUT_ORDERED(writer->total_messages, writer->total_messages + count);
+#else
+    (void)writer;
+    (void)count;
+    (void)length;
+#endif
+}
+
+/* Called where the writer waits or stops, so a slow or finished writer does not hold back a partial batch. */
+inline void rate_reporter_writer_flush(rate_reporter_writer_t *writer)
+{
+#if BENCH_INSTRUMENTATION == BENCH_INSTRUMENTATION_BATCHED
+    if (writer->unpublished > 0)
+        rate_reporter_writer_publish(writer);
+#else
+    (void)writer;
+#endif
+}
+
 inline void rate_reporter_poll_handler(void __attribute__((unused)) * clientd, const uint8_t __attribute__((unused)) * buffer, size_t length, aeron_header_t __attribute__((unused)) * header)
 {
     rate_reporter_t *reporter = (rate_reporter_t *)clientd;
 
-    AERON_PUT_ORDERED(reporter->polling_fields.total_bytes, reporter->polling_fields.total_bytes + length);
-    AERON_PUT_ORDERED(reporter->polling_fields.total_messages, reporter->polling_fields.total_messages + 1);
+    rate_reporter_writer_on_messages(&reporter->polling_fields, 1, length);
 }
 
 inline void rate_reporter_on_message(rate_reporter_t *reporter, size_t length)
 {
-    AERON_PUT_ORDERED(reporter->polling_fields.total_bytes, reporter->polling_fields.total_bytes + length);
-    AERON_PUT_ORDERED(reporter->polling_fields.total_messages, reporter->polling_fields.total_messages + 1);
+    rate_reporter_writer_on_messages(&reporter->polling_fields, 1, length);
+}
+
+inline void rate_reporter_on_messages(rate_reporter_t *reporter, uint64_t count, size_t length)
+{
+    rate_reporter_writer_on_messages(&reporter->polling_fields, count, length);
+}
+
+inline void rate_reporter_flush(rate_reporter_t *reporter)
+{
+    rate_reporter_writer_flush(&reporter->polling_fields);
 }
 
 #endif // AERON_SAMPLE_UTIL_H
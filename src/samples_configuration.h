@@ -28,6 +28,8 @@
 #define DEFAULT_MESSAGE_LENGTH (32)
 #define DEFAULT_LINGER_TIMEOUT_MS (0)
 #define DEFAULT_FRAGMENT_COUNT_LIMIT (10)
+#define DEFAULT_MAX_FRAGMENT_COUNT_LIMIT (1024)
+#define DEFAULT_BLOCK_LENGTH_LIMIT (64 * 1024)
 #define DEFAULT_RANDOM_MESSAGE_LENGTH (false)
 #define DEFAULT_PUBLICATION_RATE_PROGRESS (false)
 
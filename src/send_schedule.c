@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include <aeronc.h>
+#include <aeron_alloc.h>
+#include <util/aeron_bitutil.h>
+
+#include "send_schedule.h"
+#include "bench_random.h"
+
+/* Accepts a message rate such as 500000, 500k, 2M or 2M/s. Suffixes are decimal. */
+int send_schedule_parse_rate(const char *str, uint64_t *rate)
+{
+    char *end = NULL;
+    double value = strtod(str, &end);
+
+    if (end == str || value <= 0.0)
+    {
+        return -1;
+    }
+
+    switch (*end)
+    {
+    case 'k':
+    case 'K':
+        value *= 1e3;
+        end++;
+        break;
+    case 'm':
+    case 'M':
+        value *= 1e6;
+        end++;
+        break;
+    case 'g':
+    case 'G':
+        value *= 1e9;
+        end++;
+        break;
+    default:
+        break;
+    }
+
+    if (*end != '\0' && strcmp(end, "/s") != 0)
+    {
+        return -1;
+    }
+
+    *rate = (uint64_t)value;
+
+    return *rate > 0 ? 0 : -1;
+}
+
+int send_schedule_init_fixed_rate(send_schedule_t *schedule, uint64_t rate, uint64_t length)
+{
+    const uint64_t nanos_per_second = UINT64_C(1000) * UINT64_C(1000) * UINT64_C(1000);
+
+    if (!AERON_IS_POWER_OF_TWO(length))
+    {
+        fprintf(stderr, "send_schedule_init_fixed_rate: length %" PRIu64 " not a power of two\n", length);
+        return -1;
+    }
+
+    schedule->offsets_ns = NULL;
+    if (aeron_alloc((void **)&schedule->offsets_ns, sizeof(int64_t) * length) < 0)
+    {
+        return -1;
+    }
+
+    /* spread the rounding over the period instead of accumulating it per message */
+    for (uint64_t i = 0; i < length; i++)
+    {
+        schedule->offsets_ns[i] = (int64_t)((double)i * (double)nanos_per_second / (double)rate);
+    }
+
+    schedule->length_mask = length - 1;
+    schedule->length_shift = __builtin_ctzll(length);
+    schedule->period_ns = (int64_t)((double)length * (double)nanos_per_second / (double)rate + 0.5);
+    schedule->start_ns = 0;
+    schedule->rate = rate;
+
+    return 0;
+}
+
+/*
+ * Bursts of burst_length messages start at exponentially distributed gaps, a Poisson process of bursts
+ * (burst_length 1 is a plain Poisson arrival process). The gaps are rescaled so one period holds exactly
+ * length messages at the target rate.
+ */
+int send_schedule_init_poisson(send_schedule_t *schedule, uint64_t rate, uint64_t length, uint64_t burst_length, uint64_t seed)
+{
+    if (burst_length == 0 || burst_length > length)
+    {
+        fprintf(stderr, "send_schedule_init_poisson: burst length %" PRIu64 " out of range\n", burst_length);
+        return -1;
+    }
+
+    if (send_schedule_init_fixed_rate(schedule, rate, length) < 0)
+    {
+        return -1;
+    }
+
+    bench_random_t random;
+    uint64_t bursts = (length + burst_length - 1) / burst_length;
+    double total = 0.0;
+
+    // first pass sums the unit mean gaps, the second replays the same draws scaled to the period
+    bench_random_init(&random, seed);
+    for (uint64_t b = 0; b < bursts; b++)
+    {
+        total += -log(1.0 - bench_random_double(&random));
+    }
+
+    double scale = (double)schedule->period_ns / total;
+    double elapsed = 0.0;
+
+    bench_random_init(&random, seed);
+    for (uint64_t i = 0; i < length; i++)
+    {
+        if (i % burst_length == 0)
+        {
+            elapsed += -log(1.0 - bench_random_double(&random)) * scale;
+        }
+        schedule->offsets_ns[i] = (int64_t)elapsed;
+    }
+
+    return 0;
+}
+
+void send_schedule_close(send_schedule_t *schedule)
+{
+    aeron_free(schedule->offsets_ns);
+    schedule->offsets_ns = NULL;
+}
+
+extern void send_schedule_start(send_schedule_t *schedule, int64_t start_ns);
+extern int64_t send_schedule_intended_ns(const send_schedule_t *schedule, uint64_t i);
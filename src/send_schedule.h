@@ -0,0 +1,40 @@
+#ifndef SEND_SCHEDULE_H
+#define SEND_SCHEDULE_H
+
+#include <stdint.h>
+
+#define DEFAULT_SEND_SCHEDULE_LENGTH (64 * 1024)
+
+/*
+ * Open-loop send schedule. The intended send time of every message is fixed up front, independent of how
+ * long earlier sends took, so a publisher that falls behind does not silently lower the offered load.
+ * The offsets for one period are precomputed and the schedule repeats with that period.
+ */
+typedef struct send_schedule_stct
+{
+    int64_t *offsets_ns;
+    uint64_t length_mask;
+    int32_t length_shift;
+    int64_t period_ns;
+    int64_t start_ns;
+    uint64_t rate;
+} send_schedule_t;
+
+int send_schedule_parse_rate(const char *str, uint64_t *rate);
+int send_schedule_init_fixed_rate(send_schedule_t *schedule, uint64_t rate, uint64_t length);
+int send_schedule_init_poisson(send_schedule_t *schedule, uint64_t rate, uint64_t length, uint64_t burst_length, uint64_t seed);
+void send_schedule_close(send_schedule_t *schedule);
+
+inline void send_schedule_start(send_schedule_t *schedule, int64_t start_ns)
+{
+    schedule->start_ns = start_ns;
+}
+
+inline int64_t send_schedule_intended_ns(const send_schedule_t *schedule, uint64_t i)
+{
+    return schedule->start_ns +
+           (int64_t)(i >> schedule->length_shift) * schedule->period_ns +
+           schedule->offsets_ns[i & schedule->length_mask];
+}
+
+#endif
@@ -0,0 +1,241 @@
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <aeronc.h>
+
+#include "sequence_tracker.h"
+
+int sequence_tracker_init(sequence_tracker_t *tracker)
+{
+    memset(tracker, 0, sizeof(sequence_tracker_t));
+
+    return histogram_init(
+        &tracker->recovery_histogram, DEFAULT_HISTOGRAM_HIGHEST_TRACKABLE_VALUE, DEFAULT_HISTOGRAM_SIGNIFICANT_FIGURES);
+}
+
+void sequence_tracker_close(sequence_tracker_t *tracker)
+{
+    histogram_close(&tracker->recovery_histogram);
+}
+
+sequence_stream_t *sequence_tracker_find_stream(sequence_tracker_t *tracker, int32_t session_id, uint16_t source_id)
+{
+    for (uint32_t i = 0; i < tracker->stream_count; i++)
+    {
+        sequence_stream_t *stream = &tracker->streams[i];
+        if (stream->session_id == session_id && stream->source_id == source_id)
+        {
+            return stream;
+        }
+    }
+
+    if (tracker->stream_count >= SEQUENCE_TRACKER_MAX_STREAMS)
+    {
+        return NULL;
+    }
+
+    sequence_stream_t *stream = &tracker->streams[tracker->stream_count++];
+    stream->session_id = session_id;
+    stream->source_id = source_id;
+
+    return stream;
+}
+
+static inline bool sequence_stream_is_marked(const sequence_stream_t *stream, uint64_t sequence)
+{
+    return (stream->window[(sequence / 64) % (SEQUENCE_TRACKER_WINDOW / 64)] & (UINT64_C(1) << (sequence % 64))) != 0;
+}
+
+static inline void sequence_stream_clear(sequence_stream_t *stream, uint64_t sequence)
+{
+    stream->window[(sequence / 64) % (SEQUENCE_TRACKER_WINDOW / 64)] &= ~(UINT64_C(1) << (sequence % 64));
+}
+
+static void sequence_stream_remove_gap(sequence_stream_t *stream, uint32_t index)
+{
+    stream->open_gaps[index] = stream->open_gaps[--stream->open_gap_count];
+}
+
+static void sequence_stream_expire_gaps(sequence_tracker_t *tracker, sequence_stream_t *stream)
+{
+    if (stream->next_sequence < SEQUENCE_TRACKER_WINDOW)
+    {
+        return;
+    }
+
+    uint64_t window_start = stream->next_sequence - SEQUENCE_TRACKER_WINDOW;
+    for (uint32_t i = 0; i < stream->open_gap_count;)
+    {
+        if (stream->open_gaps[i].last_sequence < window_start)
+        {
+            stream->lost += stream->open_gaps[i].remaining;
+            tracker->lost += stream->open_gaps[i].remaining;
+            sequence_stream_remove_gap(stream, i);
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
+
+static void sequence_stream_on_sequence(sequence_tracker_t *tracker, sequence_stream_t *stream, uint64_t sequence)
+{
+    if (sequence >= stream->next_sequence)
+    {
+        if (sequence > stream->next_sequence)
+        {
+            uint64_t missing = sequence - stream->next_sequence;
+
+            // skipped sequences must not look received from a full window ago, after a jump of a whole window
+            // everything the bitmap held is older than the window and told apart by age, see sequence_stream_t
+            if (missing >= SEQUENCE_TRACKER_WINDOW)
+            {
+                memset(stream->window, 0, sizeof(stream->window));
+            }
+            else
+            {
+                for (uint64_t s = stream->next_sequence; s < sequence; s++)
+                    sequence_stream_clear(stream, s);
+            }
+
+            stream->gaps++;
+            if (stream->open_gap_count < SEQUENCE_TRACKER_MAX_OPEN_GAPS)
+            {
+                sequence_gap_t *gap = &stream->open_gaps[stream->open_gap_count++];
+                gap->first_sequence = stream->next_sequence;
+                gap->last_sequence = sequence - 1;
+                gap->remaining = missing;
+                gap->detected_ns = aeron_nano_clock();
+            }
+            else
+            {
+                stream->lost += missing;
+                tracker->lost += missing;
+            }
+        }
+
+        sequence_stream_mark(stream, sequence);
+        stream->next_sequence = sequence + 1;
+        stream->messages++;
+        sequence_stream_expire_gaps(tracker, stream);
+    }
+    else if (stream->next_sequence - sequence > SEQUENCE_TRACKER_WINDOW || sequence_stream_is_marked(stream, sequence))
+    {
+        // older than the window can not be told apart from a duplicate
+        stream->duplicates++;
+    }
+    else
+    {
+        sequence_stream_mark(stream, sequence);
+        stream->reorders++;
+        stream->messages++;
+
+        for (uint32_t i = 0; i < stream->open_gap_count; i++)
+        {
+            sequence_gap_t *gap = &stream->open_gaps[i];
+            if (sequence >= gap->first_sequence && sequence <= gap->last_sequence)
+            {
+                if (--gap->remaining == 0)
+                {
+                    histogram_record_value(&tracker->recovery_histogram, aeron_nano_clock() - gap->detected_ns);
+                    sequence_stream_remove_gap(stream, i);
+                }
+                break;
+            }
+        }
+    }
+}
+
+void sequence_stream_on_out_of_order(sequence_tracker_t *tracker, sequence_stream_t *stream, uint64_t sequence, uint64_t count)
+{
+    for (uint64_t i = 0; i < count; i++)
+    {
+        sequence_stream_on_sequence(tracker, stream, sequence + i);
+    }
+}
+
+void sequence_tracker_reset_stream(sequence_tracker_t *tracker, sequence_stream_t *stream)
+{
+    tracker->lost -= stream->lost;
+    stream->messages = 0;
+    stream->gaps = 0;
+    stream->lost = 0;
+    stream->duplicates = 0;
+    stream->reorders = 0;
+    stream->open_gap_count = 0;
+}
+
+void sequence_tracker_reset_counts(sequence_tracker_t *tracker)
+{
+    for (uint32_t i = 0; i < tracker->stream_count; i++)
+        sequence_tracker_reset_stream(tracker, &tracker->streams[i]);
+    tracker->unknown_stream_messages = 0;
+    tracker->lost = 0;
+    histogram_reset(&tracker->recovery_histogram);
+}
+
+void sequence_tracker_print_report(const sequence_tracker_t *tracker)
+{
+    uint64_t messages = 0, gaps = 0, lost = 0, outstanding = 0, duplicates = 0, reorders = 0;
+
+    for (uint32_t i = 0; i < tracker->stream_count; i++)
+    {
+        const sequence_stream_t *stream = &tracker->streams[i];
+        uint64_t stream_outstanding = 0;
+
+        for (uint32_t g = 0; g < stream->open_gap_count; g++)
+            stream_outstanding += stream->open_gaps[g].remaining;
+
+        if (tracker->stream_count > 1)
+        {
+            printf(
+                "Session %" PRId32 " source %" PRIu16 ": %" PRIu64 " messages, next sequence %" PRIu64 ", gaps %" PRIu64
+                ", lost %" PRIu64 ", outstanding %" PRIu64 ", duplicates %" PRIu64 ", reorders %" PRIu64 "\n",
+                stream->session_id,
+                stream->source_id,
+                stream->messages,
+                stream->next_sequence,
+                stream->gaps,
+                stream->lost,
+                stream_outstanding,
+                stream->duplicates,
+                stream->reorders);
+        }
+
+        messages += stream->messages;
+        gaps += stream->gaps;
+        lost += stream->lost;
+        outstanding += stream_outstanding;
+        duplicates += stream->duplicates;
+        reorders += stream->reorders;
+    }
+
+    printf(
+        "Sequences: %" PRIu32 " sources, %" PRIu64 " messages, gaps %" PRIu64 ", lost %" PRIu64 ", outstanding %" PRIu64
+        ", duplicates %" PRIu64 ", reorders %" PRIu64 "\n",
+        tracker->stream_count,
+        messages,
+        gaps,
+        lost,
+        outstanding,
+        duplicates,
+        reorders);
+
+    if (tracker->unknown_stream_messages > 0)
+    {
+        printf("Untracked messages beyond %d sources %" PRIu64 "\n", SEQUENCE_TRACKER_MAX_STREAMS, tracker->unknown_stream_messages);
+    }
+
+    if (tracker->recovery_histogram.total_count > 0)
+    {
+        print_latency_report("Gap recovery", &tracker->recovery_histogram);
+    }
+}
+
+extern uint64_t sequence_tracker_lost(const sequence_tracker_t *tracker);
+extern uint64_t sequence_tracker_gaps(const sequence_tracker_t *tracker);
+extern void sequence_stream_mark(sequence_stream_t *stream, uint64_t sequence);
+extern void sequence_tracker_on_frame(
+    sequence_tracker_t *tracker, int32_t session_id, uint16_t source_id, uint64_t sequence, uint64_t count);
@@ -0,0 +1,125 @@
+#ifndef SEQUENCE_TRACKER_H
+#define SEQUENCE_TRACKER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "histogram.h"
+
+#define SEQUENCE_TRACKER_MAX_STREAMS (64)
+#define SEQUENCE_TRACKER_WINDOW (1024)
+#define SEQUENCE_TRACKER_MAX_OPEN_GAPS (64)
+
+typedef struct sequence_gap_stct
+{
+    uint64_t first_sequence;
+    uint64_t last_sequence;
+    uint64_t remaining;
+    int64_t detected_ns;
+} sequence_gap_t;
+
+/*
+ * Sequence state of one source within one session. Sequences below next_sequence are remembered in a
+ * bitmap window, so a late sequence can be told apart as a reorder filling a gap or as a duplicate.
+ * A gap that slides out of the window unfilled is counted as lost. A stream starts at the first sequence it
+ * sees, so joining a publication already under way counts nothing before it as missing.
+ *
+ * Only the last SEQUENCE_TRACKER_WINDOW sequences are told apart. Anything older is counted as a duplicate by
+ * its age alone, whether or not it was seen. A jump of a whole window or more clears the bitmap, and every
+ * sequence it held is then older than the window, so a cleared bit never turns a duplicate into a reorder.
+ * The cost is that a fill arriving more than a window late counts as a duplicate, its sequence already
+ * counted as lost or still outstanding in its gap.
+ */
+typedef struct sequence_stream_stct
+{
+    int32_t session_id;
+    uint16_t source_id;
+    bool seeded;
+
+    uint64_t next_sequence;
+    uint64_t window[SEQUENCE_TRACKER_WINDOW / 64];
+
+    uint64_t messages;
+    uint64_t gaps;
+    uint64_t lost;
+    uint64_t duplicates;
+    uint64_t reorders;
+
+    uint32_t open_gap_count;
+    sequence_gap_t open_gaps[SEQUENCE_TRACKER_MAX_OPEN_GAPS];
+} sequence_stream_t;
+
+typedef struct sequence_tracker_stct
+{
+    sequence_stream_t *last_stream;
+    uint32_t stream_count;
+    uint64_t unknown_stream_messages;
+    uint64_t lost;
+    histogram_t recovery_histogram;
+    sequence_stream_t streams[SEQUENCE_TRACKER_MAX_STREAMS];
+} sequence_tracker_t;
+
+int sequence_tracker_init(sequence_tracker_t *tracker);
+void sequence_tracker_close(sequence_tracker_t *tracker);
+
+sequence_stream_t *sequence_tracker_find_stream(sequence_tracker_t *tracker, int32_t session_id, uint16_t source_id);
+void sequence_stream_on_out_of_order(sequence_tracker_t *tracker, sequence_stream_t *stream, uint64_t sequence, uint64_t count);
+/* Zeroes the counts and drops the open gaps, the sequences and windows carry on. */
+void sequence_tracker_reset_stream(sequence_tracker_t *tracker, sequence_stream_t *stream);
+void sequence_tracker_reset_counts(sequence_tracker_t *tracker);
+void sequence_tracker_print_report(const sequence_tracker_t *tracker);
+
+inline uint64_t sequence_tracker_lost(const sequence_tracker_t *tracker)
+{
+    return tracker->lost;
+}
+
+inline uint64_t sequence_tracker_gaps(const sequence_tracker_t *tracker)
+{
+    uint64_t gaps = 0;
+    for (uint32_t i = 0; i < tracker->stream_count; i++)
+        gaps += tracker->streams[i].gaps;
+    return gaps;
+}
+
+inline void sequence_stream_mark(sequence_stream_t *stream, uint64_t sequence)
+{
+    stream->window[(sequence / 64) % (SEQUENCE_TRACKER_WINDOW / 64)] |= UINT64_C(1) << (sequence % 64);
+}
+
+/* Records count messages starting at sequence, the common in-order case stays inline. */
+inline void sequence_tracker_on_frame(
+    sequence_tracker_t *tracker, int32_t session_id, uint16_t source_id, uint64_t sequence, uint64_t count)
+{
+    sequence_stream_t *stream = tracker->last_stream;
+    if (NULL == stream || stream->session_id != session_id || stream->source_id != source_id)
+    {
+        if (NULL == (stream = sequence_tracker_find_stream(tracker, session_id, source_id)))
+        {
+            tracker->unknown_stream_messages += count;
+            return;
+        }
+        tracker->last_stream = stream;
+
+        // a new stream is only ever reached through the lookup, never as the last stream
+        if (!stream->seeded)
+        {
+            stream->next_sequence = sequence;
+            stream->seeded = true;
+        }
+    }
+
+    if (sequence == stream->next_sequence && count <= 64 && stream->open_gap_count == 0)
+    {
+        for (uint64_t i = 0; i < count; i++)
+            sequence_stream_mark(stream, sequence + i);
+        stream->next_sequence = sequence + count;
+        stream->messages += count;
+    }
+    else
+    {
+        sequence_stream_on_out_of_order(tracker, stream, sequence, count);
+    }
+}
+
+#endif
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "steady_state.h"
+
+void steady_state_init(steady_state_t *state, double tolerance)
+{
+    memset(state, 0, sizeof(steady_state_t));
+    state->tolerance = tolerance;
+}
+
+static bool steady_state_rates_agree(const steady_state_t *state)
+{
+    double mean = 0.0;
+
+    for (int i = 0; i < STEADY_STATE_WINDOWS; i++)
+        mean += state->rates[i];
+    mean /= STEADY_STATE_WINDOWS;
+
+    if (mean <= 0.0)
+        return false;
+
+    for (int i = 0; i < STEADY_STATE_WINDOWS; i++)
+    {
+        double deviation = state->rates[i] > mean ? state->rates[i] - mean : mean - state->rates[i];
+        if (deviation > state->tolerance * mean)
+            return false;
+    }
+
+    return true;
+}
+
+bool steady_state_on_progress(steady_state_t *state, int64_t now_ns, uint64_t messages)
+{
+    if (state->steady)
+        return false;
+
+    if (state->first_ns == 0 || messages < state->window_start_messages)
+    {
+        if (state->first_ns == 0)
+            state->first_ns = now_ns;
+        state->window_start_ns = now_ns;
+        state->window_start_messages = messages;
+        state->window_count = 0;
+        return false;
+    }
+
+    int64_t window_ns = now_ns - state->window_start_ns;
+    if (window_ns < STEADY_STATE_WINDOW_NS)
+        return false;
+
+    state->rates[state->window_count % STEADY_STATE_WINDOWS] =
+        (double)(messages - state->window_start_messages) * 1e9 / (double)window_ns;
+    state->window_count++;
+    state->window_start_ns = now_ns;
+    state->window_start_messages = messages;
+
+    if (state->window_count >= STEADY_STATE_WINDOWS && steady_state_rates_agree(state))
+        state->steady = true;
+    else if (state->window_count >= STEADY_STATE_MAX_WINDOWS)
+        state->steady = state->gave_up = true;
+
+    if (state->steady)
+        state->steady_after_ns = now_ns - state->first_ns;
+
+    return state->steady;
+}
+
+void steady_state_print_report(const steady_state_t *state)
+{
+    if (state->gave_up)
+    {
+        printf("Steady state: rate still varying by more than %g after %.1f s, measured from there\n",
+               state->tolerance, (double)state->steady_after_ns / 1e9);
+    }
+    else if (state->steady)
+    {
+        printf("Steady state: rate within %g after %.1f s, measured from there\n",
+               state->tolerance, (double)state->steady_after_ns / 1e9);
+    }
+    else
+    {
+        printf("Steady state: not reached, the whole run is measured\n");
+    }
+}
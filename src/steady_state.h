@@ -0,0 +1,42 @@
+#ifndef STEADY_STATE_H
+#define STEADY_STATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* The receive rate is taken over windows of this length. */
+#define STEADY_STATE_WINDOW_NS (INT64_C(100) * 1000 * 1000)
+/* Consecutive windows that have to agree. */
+#define STEADY_STATE_WINDOWS (5)
+/* Windows after which a rate that never settles is taken as it is, 10s. */
+#define STEADY_STATE_MAX_WINDOWS (100)
+/* Polls with work between two looks at the clock, every idle poll looks so sparse polls keep the window length. */
+#define STEADY_STATE_CHECK_POLLS (1024)
+
+/*
+ * Detects the end of the ramp-up from the receive rate. The run is steady once the rates of the last
+ * STEADY_STATE_WINDOWS windows are all within tolerance of their mean, or after STEADY_STATE_MAX_WINDOWS
+ * windows so a run that never settles is still measured.
+ */
+typedef struct steady_state_stct
+{
+    double tolerance;
+    double rates[STEADY_STATE_WINDOWS];
+    uint64_t window_count;
+    uint64_t window_start_messages;
+    int64_t window_start_ns;
+    int64_t first_ns;
+    int64_t steady_after_ns;
+    bool steady;
+    bool gave_up;
+} steady_state_t;
+
+void steady_state_init(steady_state_t *state, double tolerance);
+/*
+ * Feeds the messages received so far, true once when the rate has become steady. A count going backwards,
+ * because the statistics were reset, starts the windows again.
+ */
+bool steady_state_on_progress(steady_state_t *state, int64_t now_ns, uint64_t messages);
+void steady_state_print_report(const steady_state_t *state);
+
+#endif
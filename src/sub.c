@@ -23,40 +23,127 @@
 #include <signal.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 #include <inttypes.h>
+#include <pthread.h>
 
 #if !defined(_MSC_VER)
 #include <unistd.h>
 #endif
 
 #include <aeron_agent.h>
+#include <aeron_alloc.h>
 #include <aeronc.h>
 #include <concurrent/aeron_atomic.h>
+#include <concurrent/aeron_logbuffer_descriptor.h>
+#include <protocol/aeron_udp_protocol.h>
+#include <util/aeron_bitutil.h>
 #include <util/aeron_parse_util.h>
 #include <util/aeron_strutil.h>
 
 #include "samples_configuration.h"
 #include "sample_util.h"
 #include "nms_messages.h"
+#include "bench_message.h"
+#include "histogram.h"
+#include "embedded_driver.h"
+#include "sequence_tracker.h"
+#include "message_dispatcher.h"
+#include "top_of_book.h"
+#include "feed_generator.h"
+#include "capture.h"
+#include "json_report.h"
+#include "idle_strategy.h"
+#include "cpu_time.h"
+#include "affinity.h"
+#include "bench_counters.h"
+#include "perf_counters.h"
+#include "bench_clock.h"
+#include "steady_state.h"
 
 const char usage_str[] =
-    "[-h][-v][-c uri][-p prefix][-s stream-id]\n"
+    "[-h][-v][-L][-P][-J][-K][-E][-O][-a cpus][-C cpu][-N node][-B contracts][-W journal][-g segment][-c uri][-G images][-M mode][-f limit][-b length][-i idle][-o clock][-S tolerance][-m messages][-p prefix][-D mode][-I idle][-s stream-id][-T timeout]\n"
     "    -h               help\n"
     "    -v               show version and exit\n"
+    "    -L               record publish-to-receive latency from the message timestamp\n"
     "    -P               print progress\n"
+    "    -J               print a JSON summary line at the end, for sweep scripts\n"
+    "    -E               count cycles, instructions, cache and branch misses and context switches of the polling\n"
+    "                     thread with perf_event_open, reported per message with -P and at the end\n"
+    "    -O               report the cost of a clock read before subscribing\n"
+    "    -K               export messages, bytes, gaps, losses and latency percentiles as counters in the CnC file\n"
+    "    -a cpus          pin the polling thread to the first of cpus (e.g. 2,4-7), after the client and driver threads\n"
+    "                     are started, or with -G the image threads to cpus in turn\n"
+    "    -C cpu           pin the progress reporter thread to cpu\n"
+    "    -N node          run on NUMA node and allocate the book, journal and histograms there\n"
+    "    -B contracts     keep top of book per contract in a table sized for contracts, as pub -k (e.g. 1.5M)\n"
+    "    -W journal       append every fragment and its receive time to a memory-mapped journal, replayable with pub -F\n"
+    "    -g segment       journal preallocation and growth step (default 256m)\n"
     "    -p prefix        aeron.dir location specified as prefix\n"
+    "    -D mode          run an embedded media driver: dedicated, shared-network or shared\n"
+    "    -I idle          idle strategy of the embedded driver agents (e.g. noop, busy_spin, yield, sleep-ns)\n"
     "    -c uri           use channel specified in uri\n"
+    "    -G images        poll every image on a thread of its own and report each image, up to images over the\n"
+    "                     run (at most 256); not with -B, -K, -S or -W\n"
+    "    -M mode          how fragments are polled: assembler (default) reassembles fragmented messages, poll hands\n"
+    "                     over single frames without an assembler, controlled polls the same with a controlled\n"
+    "                     handler, block walks the contiguous frames of each image in place\n"
+    "    -f limit         fragment count limit of each poll (default 10), or adaptive[:max] to double it while polls\n"
+    "                     fill it and halve it back while they read under a quarter of it (max 1024)\n"
+    "    -b length        byte limit of each block poll (default 64k)\n"
+    "    -i idle          idle strategy after an empty poll: busy-spin (default), noop, yield, backoff or sleeping[:duration]\n"
+    "    -o clock         clock for receive times and latency: auto (default), tsc or monotonic\n"
+    "    -S tolerance     measure from when the receive rate is steady, the last 5 rates of 100ms within tolerance\n"
+    "                     of their mean (e.g. 0.05), on top of the publisher's warm-up marker\n"
     "    -s stream-id     stream-id to use\n"
-    "    -m messages      number of messages to receive\n";
+    "    -m messages      number of messages to receive, lost messages included\n"
+    "    -T timeout       stop when nothing arrives for timeout after the first message (e.g. 5s)\n";
+
+#define IMAGE_WORKERS_MAX (256)
 
 volatile bool running = true;
 
+typedef enum poll_mode_en
+{
+    POLL_MODE_ASSEMBLER = 0,
+    POLL_MODE_POLL = 1,
+    POLL_MODE_CONTROLLED = 2,
+    POLL_MODE_BLOCK = 3
+} poll_mode_t;
+
+static const char *poll_mode_names[] = {"assembler", "poll", "controlled", "block"};
+
+typedef struct warm_up_source_stct
+{
+    int32_t session_id;
+    uint16_t source_id;
+} warm_up_source_t;
+
 typedef struct handler_data
 {
     aeron_subscription_t *subscription;
-    rate_reporter_t *rate_reporter;
+    rate_reporter_writer_t *rate_reporter_writer;
+    histogram_t *latency_histogram;
+    top_of_book_t *top_of_book;
+    capture_writer_t *journal;
+    int64_t last_receive_timestamp_ns;
     uint64_t limit;
     uint64_t messages;
+    uint64_t bytes;
+    uint64_t malformed_fragments;
+    uint64_t fragmented_frames;
+    uint64_t trade_volume;
+    uint64_t trade_notional;
+    uint64_t quote_spread_sum;
+    uint64_t crossed_quotes;
+    message_dispatcher_t dispatcher;
+    sequence_tracker_t sequence_tracker;
+    bench_clock_t clock;
+    uint64_t warm_up_messages;
+    uint32_t warm_up_sources;
+    uint32_t warm_up_end_count;
+    warm_up_source_t warm_up_ended[SEQUENCE_TRACKER_MAX_STREAMS];
+    bool restart_measurement;
 } handler_data_t;
 
 void sigint_handler(int __attribute__((unused)) signal)
@@ -71,7 +158,182 @@ inline bool is_running(void)
     return result;
 }
 
-void poll_handler(void *clientd, const uint8_t __attribute__((unused)) * buffer, size_t length, aeron_header_t __attribute__((unused)) * header)
+inline void record_message_latency(handler_data_t *data, XC_HITIME timestamp)
+{
+    if (data->latency_histogram != NULL)
+        histogram_record_value(data->latency_histogram, data->last_receive_timestamp_ns - (int64_t)timestamp);
+}
+
+/* Decoders read the fields in place and fold them into totals, like a consumer would, so decode cost is measured. */
+void trade_handler(void *clientd, const uint8_t *body)
+{
+    handler_data_t *data = (handler_data_t *)clientd;
+    const struct nms_opra_trade_t *trade = (const struct nms_opra_trade_t *)body;
+
+    data->trade_volume += trade->volume;
+    data->trade_notional += (uint64_t)trade->premium_price * trade->volume;
+    if (data->top_of_book != NULL)
+        top_of_book_on_trade(data->top_of_book, trade);
+    record_message_latency(data, trade->timestamp);
+}
+
+void quote_handler(void *clientd, const uint8_t *body)
+{
+    handler_data_t *data = (handler_data_t *)clientd;
+    const struct nms_opra_quote_t *quote = (const struct nms_opra_quote_t *)body;
+
+    if (quote->ask_price >= quote->bid_price)
+        data->quote_spread_sum += quote->ask_price - quote->bid_price;
+    else
+        data->crossed_quotes++;
+    if (data->top_of_book != NULL)
+        top_of_book_on_quote(data->top_of_book, quote);
+    record_message_latency(data, quote->timestamp);
+}
+
+/*
+ * Drops everything counted so far, the sequences carry on so the measured messages follow without a gap.
+ * What the polling loop measures itself is restarted there, on restart_measurement.
+ */
+static void reset_statistics(handler_data_t *data)
+{
+    data->warm_up_messages += data->messages;
+    data->messages = 0;
+    data->bytes = 0;
+    data->malformed_fragments = 0;
+    data->trade_volume = 0;
+    data->trade_notional = 0;
+    data->quote_spread_sum = 0;
+    data->crossed_quotes = 0;
+    message_dispatcher_reset_counts(&data->dispatcher);
+    sequence_tracker_reset_counts(&data->sequence_tracker);
+    if (data->top_of_book != NULL)
+        top_of_book_reset_counts(data->top_of_book);
+    if (data->latency_histogram != NULL)
+        histogram_reset(data->latency_histogram);
+    data->restart_measurement = true;
+}
+
+static bool warm_up_source_ended(const handler_data_t *data, int32_t session_id, uint16_t source_id)
+{
+    for (uint32_t i = 0; i < data->warm_up_end_count; i++)
+    {
+        if (data->warm_up_ended[i].session_id == session_id && data->warm_up_ended[i].source_id == source_id)
+            return true;
+    }
+
+    return false;
+}
+
+/*
+ * The first marker restarts the measurement. Every session announces its sources with its first marker,
+ * which only counts them for the report, the warm-up frames themselves are flagged in their header.
+ */
+static void on_warm_up_end(handler_data_t *data, int32_t session_id, uint16_t source_id, uint16_t sources)
+{
+    bool new_session = true;
+
+    if (data->warm_up_end_count >= SEQUENCE_TRACKER_MAX_STREAMS || warm_up_source_ended(data, session_id, source_id))
+        return;
+
+    for (uint32_t i = 0; i < data->warm_up_end_count; i++)
+    {
+        if (data->warm_up_ended[i].session_id == session_id)
+            new_session = false;
+    }
+    if (new_session)
+        data->warm_up_sources += sources;
+
+    data->warm_up_ended[data->warm_up_end_count].session_id = session_id;
+    data->warm_up_ended[data->warm_up_end_count].source_id = source_id;
+    if (data->warm_up_end_count++ == 0)
+    {
+        reset_statistics(data);
+    }
+    else
+    {
+        sequence_stream_t *stream = sequence_tracker_find_stream(&data->sequence_tracker, session_id, source_id);
+        if (NULL != stream)
+            sequence_tracker_reset_stream(&data->sequence_tracker, stream);
+    }
+}
+
+/* Everything done with a benchmark frame once it has arrived, whichever way it was polled. */
+static inline void on_frame(handler_data_t *data, const uint8_t *buffer, size_t length, bool has_session_id, int32_t session_id)
+{
+    if (data->journal != NULL && capture_writer_append(data->journal, buffer, length, data->last_receive_timestamp_ns) < 0)
+    {
+        sigint_handler(0);
+        return;
+    }
+
+    if (length < BENCH_FRAME_HEADER_LENGTH)
+    {
+        data->malformed_fragments++;
+        return;
+    }
+
+    const struct bench_frame_header_t *frame = (const struct bench_frame_header_t *)buffer;
+
+    // only frames without messages can be a marker, the check stays off the path of every other frame
+    const struct bench_warm_up_end_t *warm_up_end;
+    if (frame->count == 0 && NULL != (warm_up_end = bench_warm_up_end(buffer, length)))
+    {
+        on_warm_up_end(data, session_id, frame->source_id, warm_up_end->sources);
+        return;
+    }
+
+    // from the very first frame, before any marker has said how many sources warm up
+    if (0 != (frame->source_id & BENCH_WARM_UP_SOURCE_FLAG))
+    {
+        if (has_session_id)
+            sequence_tracker_on_frame(
+                &data->sequence_tracker, session_id, frame->source_id & BENCH_SOURCE_ID_MASK, frame->sequence, frame->count);
+        data->warm_up_messages += frame->count;
+        return;
+    }
+
+    int64_t dispatched = message_dispatcher_on_messages(
+        &data->dispatcher, buffer + BENCH_FRAME_HEADER_LENGTH, length - BENCH_FRAME_HEADER_LENGTH, frame->count);
+    if (dispatched < 0)
+    {
+        data->malformed_fragments++;
+        return;
+    }
+    uint64_t count = (uint64_t)dispatched;
+
+    if (has_session_id)
+        sequence_tracker_on_frame(&data->sequence_tracker, session_id, frame->source_id, frame->sequence, count);
+
+    if (data->rate_reporter_writer != NULL)
+        rate_reporter_writer_on_messages(data->rate_reporter_writer, count, length);
+
+    data->messages += count;
+    data->bytes += length;
+    if (data->limit != 0 && data->messages + sequence_tracker_lost(&data->sequence_tracker) >= data->limit)
+        sigint_handler(0);
+}
+
+static inline void on_fragment(handler_data_t *data, const uint8_t *buffer, size_t length, aeron_header_t *header, bool assembled)
+{
+    aeron_header_values_t header_values;
+    bool has_header_values = aeron_header_values(header, &header_values) == 0;
+
+    // without the assembler a fragment of a larger message can only be dropped, benchmark frames fit one MTU
+    if (!assembled && has_header_values &&
+        (header_values.frame.flags & AERON_DATA_HEADER_UNFRAGMENTED) != AERON_DATA_HEADER_UNFRAGMENTED)
+    {
+        data->fragmented_frames++;
+        return;
+    }
+
+    if (data->latency_histogram != NULL || data->journal != NULL)
+        data->last_receive_timestamp_ns = bench_clock_ns(&data->clock);
+
+    on_frame(data, buffer, length, has_header_values, has_header_values ? header_values.frame.session_id : 0);
+}
+
+void poll_handler(void *clientd, const uint8_t *buffer, size_t length, aeron_header_t *header)
 {
     // aeron_subscription_t *subscription = (aeron_subscription_t *)clientd;
     // aeron_subscription_constants_t subscription_constants;
@@ -91,13 +353,495 @@ void poll_handler(void *clientd, const uint8_t __attribute__((unused)) * buffer,
     //     (int)length,
     //     buffer);
 
+    on_fragment((handler_data_t *)clientd, buffer, length, header, true);
+}
+
+void unassembled_poll_handler(void *clientd, const uint8_t *buffer, size_t length, aeron_header_t *header)
+{
+    on_fragment((handler_data_t *)clientd, buffer, length, header, false);
+}
+
+/* Stops consuming at the message limit, the fragments after it stay in the image. */
+aeron_controlled_fragment_handler_action_t controlled_poll_handler(
+    void *clientd, const uint8_t *buffer, size_t length, aeron_header_t *header)
+{
+    on_fragment((handler_data_t *)clientd, buffer, length, header, false);
+
+    return is_running() ? AERON_ACTION_CONTINUE : AERON_ACTION_BREAK;
+}
+
+/*
+ * A block is every frame of one image that is contiguous in its term, up to the block length limit. The
+ * frames are walked in place and share one receive time, they were all in the term when the poll found them.
+ */
+void block_poll_handler(void *clientd, const uint8_t *buffer, size_t length, int32_t session_id, int32_t term_id)
+{
     handler_data_t *data = (handler_data_t *)clientd;
-    if (data->rate_reporter != NULL)
-        rate_reporter_on_message(data->rate_reporter, length);
+    (void)term_id;
 
-    data->messages++;
-    if (data->limit != 0 && data->messages >= data->limit)
-        sigint_handler(0);
+    if (data->latency_histogram != NULL || data->journal != NULL)
+        data->last_receive_timestamp_ns = bench_clock_ns(&data->clock);
+
+    for (size_t offset = 0; offset + AERON_DATA_HEADER_LENGTH <= length;)
+    {
+        const aeron_data_header_t *header = (const aeron_data_header_t *)(buffer + offset);
+        int32_t frame_length = header->frame_header.frame_length;
+        if (frame_length < (int32_t)AERON_DATA_HEADER_LENGTH)
+            break;
+
+        if (header->frame_header.type == AERON_HDR_TYPE_DATA)
+        {
+            if ((header->frame_header.flags & AERON_DATA_HEADER_UNFRAGMENTED) == AERON_DATA_HEADER_UNFRAGMENTED)
+                on_frame(data, buffer + offset + AERON_DATA_HEADER_LENGTH, (size_t)frame_length - AERON_DATA_HEADER_LENGTH, true, session_id);
+            else
+                data->fragmented_frames++;
+        }
+
+        offset += AERON_ALIGN((size_t)frame_length, AERON_LOGBUFFER_FRAME_ALIGNMENT);
+    }
+}
+
+static int parse_poll_mode(const char *spec, poll_mode_t *mode)
+{
+    for (size_t i = 0; i < sizeof(poll_mode_names) / sizeof(poll_mode_names[0]); i++)
+    {
+        if (strcmp(spec, poll_mode_names[i]) == 0)
+        {
+            *mode = (poll_mode_t)i;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+/* Doubles a limit the last poll filled, halves one it used under a quarter of, within min and max. */
+static inline size_t adapt_fragment_limit(size_t limit, int fragments_read, size_t min_limit, size_t max_limit)
+{
+    if ((size_t)fragments_read >= limit && limit < max_limit)
+        return limit * 2 < max_limit ? limit * 2 : max_limit;
+    if ((size_t)fragments_read < limit / 4 && limit > min_limit)
+        return limit / 2 > min_limit ? limit / 2 : min_limit;
+
+    return limit;
+}
+
+static void update_counters(bench_counters_t *counters, const handler_data_t *data)
+{
+    bench_counters_set(counters, BENCH_COUNTER_MESSAGES, (int64_t)data->messages);
+    bench_counters_set(counters, BENCH_COUNTER_BYTES, (int64_t)data->bytes);
+    bench_counters_set(counters, BENCH_COUNTER_GAPS, (int64_t)sequence_tracker_gaps(&data->sequence_tracker));
+    bench_counters_set(counters, BENCH_COUNTER_LOST, (int64_t)sequence_tracker_lost(&data->sequence_tracker));
+    bench_counters_set(counters, BENCH_COUNTER_MALFORMED, (int64_t)data->malformed_fragments);
+}
+
+/* Percentiles of an interval are set as it is folded into the total, the same cadence as the interval report. */
+static void update_latency_counters(bench_counters_t *counters, const histogram_t *histogram)
+{
+    bench_counters_set(counters, BENCH_COUNTER_LATENCY_P50_NS, histogram_value_at_percentile(histogram, 50.0));
+    bench_counters_set(counters, BENCH_COUNTER_LATENCY_P99_NS, histogram_value_at_percentile(histogram, 99.0));
+    bench_counters_set(counters, BENCH_COUNTER_LATENCY_P99_9_NS, histogram_value_at_percentile(histogram, 99.9));
+    bench_counters_set(counters, BENCH_COUNTER_LATENCY_MAX_NS, histogram->max_value);
+}
+
+/*
+ * One thread per image, for a stream with several publishers. The client conductor hands every image it
+ * reports to the next free slot, the main thread starts a thread for the slot and the thread polls only that
+ * image with handler data of its own, so nothing on the receive path is shared. Slots are not reused, an
+ * image that goes away keeps its statistics for the report.
+ */
+typedef struct image_worker_stct
+{
+    pthread_t thread;
+    size_t index;
+    int cpu;
+    struct image_workers_stct *workers;
+    aeron_subscription_t *subscription;
+    aeron_image_t *image;
+    int32_t session_id;
+    char source_identity[64];
+    handler_data_t data;
+    histogram_t latency_histogram;
+    aeron_fragment_assembler_t *fragment_assembler;
+    idle_strategy_t idle_strategy;
+    perf_counters_t *perf_counters;
+    perf_counter_values_t perf_values;
+    bool started;
+    bool closed;
+    volatile bool unavailable;
+    volatile uint64_t received;
+
+    size_t poll_limit;
+    uint64_t polls;
+    uint64_t empty_polls;
+    uint64_t read_total;
+    int64_t start_timestamp_ns;
+    int64_t end_timestamp_ns;
+    int64_t cpu_time_ns;
+} image_worker_t;
+
+typedef struct image_workers_stct
+{
+    image_worker_t *workers;
+    perf_counters_t *perf_counters;
+    size_t capacity;
+    volatile size_t count;
+    volatile uint64_t ignored;
+    size_t started;
+
+    poll_mode_t poll_mode;
+    size_t fragment_limit;
+    size_t max_fragment_limit;
+    bool adaptive_fragment_limit;
+    size_t block_length_limit;
+    const char *idle_strategy_spec;
+    bool record_latency;
+    rate_reporter_t *rate_reporter;
+    const bench_clock_t *clock;
+    const int *cpus;
+    int cpu_count;
+} image_workers_t;
+
+static int image_workers_init(image_workers_t *workers, size_t capacity, bool measure_perf)
+{
+    workers->capacity = capacity;
+    if (aeron_alloc((void **)&workers->workers, sizeof(image_worker_t) * capacity) < 0 ||
+        (measure_perf && aeron_alloc((void **)&workers->perf_counters, sizeof(perf_counters_t) * capacity) < 0))
+    {
+        fprintf(stderr, "image_workers_init: %s\n", aeron_errmsg());
+        return -1;
+    }
+
+    for (size_t i = 0; i < capacity; i++)
+    {
+        workers->workers[i].index = i;
+        workers->workers[i].workers = workers;
+        workers->workers[i].perf_counters = measure_perf ? &workers->perf_counters[i] : NULL;
+    }
+
+    return 0;
+}
+
+/* On the client conductor thread. The image is retained for its thread, which releases it when done. */
+void image_worker_on_available(void *clientd, aeron_subscription_t *subscription, aeron_image_t *image)
+{
+    image_workers_t *workers = (image_workers_t *)clientd;
+    aeron_image_constants_t image_constants;
+    size_t count;
+
+    print_available_image(NULL, subscription, image);
+
+    AERON_GET_VOLATILE(count, workers->count);
+    if (count >= workers->capacity)
+    {
+        fprintf(stderr, "image_worker_on_available: all %zu image threads taken, image not polled\n", workers->capacity);
+        AERON_PUT_ORDERED(workers->ignored, workers->ignored + 1);
+        return;
+    }
+
+    if (aeron_image_constants(image, &image_constants) < 0 || aeron_subscription_image_retain(subscription, image) < 0)
+    {
+        fprintf(stderr, "image_worker_on_available: %s\n", aeron_errmsg());
+        return;
+    }
+
+    image_worker_t *worker = &workers->workers[count];
+    worker->subscription = subscription;
+    worker->image = image;
+    worker->session_id = image_constants.session_id;
+    snprintf(worker->source_identity, sizeof(worker->source_identity), "%s", image_constants.source_identity);
+    AERON_PUT_ORDERED(workers->count, count + 1);
+}
+
+/* On the client conductor thread, the image's thread drains what is left and stops. */
+void image_worker_on_unavailable(void *clientd, aeron_subscription_t *subscription, aeron_image_t *image)
+{
+    image_workers_t *workers = (image_workers_t *)clientd;
+    size_t count;
+
+    print_unavailable_image(NULL, subscription, image);
+
+    AERON_GET_VOLATILE(count, workers->count);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (workers->workers[i].image == image)
+            AERON_PUT_ORDERED(workers->workers[i].unavailable, true);
+    }
+}
+
+static inline int image_worker_poll(image_worker_t *worker, poll_mode_t poll_mode)
+{
+    switch (poll_mode)
+    {
+    case POLL_MODE_POLL:
+        return aeron_image_poll(worker->image, unassembled_poll_handler, &worker->data, worker->poll_limit);
+
+    case POLL_MODE_CONTROLLED:
+        return aeron_image_controlled_poll(worker->image, controlled_poll_handler, &worker->data, worker->poll_limit);
+
+    case POLL_MODE_BLOCK:
+        return aeron_image_block_poll(worker->image, block_poll_handler, &worker->data, worker->workers->block_length_limit);
+
+    default:
+        return aeron_image_poll(worker->image, aeron_fragment_assembler_handler, worker->fragment_assembler, worker->poll_limit);
+    }
+}
+
+void *image_worker_run(void *arg)
+{
+    image_worker_t *worker = (image_worker_t *)arg;
+    const image_workers_t *workers = worker->workers;
+    handler_data_t *data = &worker->data;
+    perf_counter_values_t perf_start = {0};
+    int64_t idle_since_ns = 0;
+
+    char label[32];
+    snprintf(label, sizeof(label), "Image %zu", worker->index);
+    affinity_pin_current_thread(worker->cpu);
+    affinity_print_placement(label);
+
+    if (NULL != worker->perf_counters)
+        perf_counters_open(worker->perf_counters);
+    int64_t cpu_start_ns = cpu_time_thread_ns();
+
+    while (is_running())
+    {
+        int fragments_read = image_worker_poll(worker, workers->poll_mode);
+        if (fragments_read < 0)
+        {
+            fprintf(stderr, "image %zu %s poll: %s\n", worker->index, poll_mode_names[workers->poll_mode], aeron_errmsg());
+            sigint_handler(0);
+            break;
+        }
+
+        worker->polls++;
+        worker->read_total += (uint64_t)fragments_read;
+        if (workers->adaptive_fragment_limit)
+            worker->poll_limit = adapt_fragment_limit(worker->poll_limit, fragments_read, workers->fragment_limit, workers->max_fragment_limit);
+
+        if (worker->start_timestamp_ns == 0 && fragments_read > 0)
+        {
+            if (NULL != worker->perf_counters)
+                perf_counters_read(worker->perf_counters, &perf_start);
+            worker->start_timestamp_ns = bench_clock_ns(&data->clock);
+        }
+
+        if (data->restart_measurement)
+        {
+            // this image's warm-up is over, it is counted again from here
+            data->restart_measurement = false;
+            if (NULL != worker->perf_counters)
+                perf_counters_read(worker->perf_counters, &perf_start);
+            worker->start_timestamp_ns = bench_clock_ns(&data->clock);
+            cpu_start_ns = cpu_time_thread_ns();
+        }
+
+        if (fragments_read > 0)
+        {
+            idle_since_ns = 0;
+            // what the main thread holds against the message limit, one store per poll
+            AERON_PUT_ORDERED(worker->received, data->messages + sequence_tracker_lost(&data->sequence_tracker));
+        }
+        else
+        {
+            worker->empty_polls++;
+            if (NULL != data->rate_reporter_writer)
+                rate_reporter_writer_flush(data->rate_reporter_writer);
+
+            // the start of the last quiet spell is when the image's run ended, should it turn out to be closed
+            if (idle_since_ns == 0)
+                idle_since_ns = bench_clock_ns(&data->clock);
+
+            bool unavailable;
+            AERON_GET_VOLATILE(unavailable, worker->unavailable);
+            if (unavailable || aeron_image_is_closed(worker->image))
+            {
+                worker->closed = true;
+                break;
+            }
+        }
+
+        idle_strategy_idle(&worker->idle_strategy, fragments_read);
+    }
+
+    worker->end_timestamp_ns = idle_since_ns != 0 ? idle_since_ns : bench_clock_ns(&data->clock);
+    // unlike the run, CPU time and counters of a closed image include the wait until the close was seen
+    worker->cpu_time_ns = cpu_time_thread_ns() - cpu_start_ns;
+    if (NULL != worker->perf_counters && perf_counters_read(worker->perf_counters, &worker->perf_values) == 0)
+        perf_counter_values_sub(&worker->perf_values, &perf_start);
+    if (NULL != data->rate_reporter_writer)
+        rate_reporter_writer_flush(data->rate_reporter_writer);
+
+    aeron_subscription_image_release(worker->subscription, worker->image);
+
+    return NULL;
+}
+
+static int image_worker_start(image_workers_t *workers, image_worker_t *worker)
+{
+    handler_data_t *data = &worker->data;
+
+    worker->cpu = workers->cpu_count > 0 ? workers->cpus[worker->index % (size_t)workers->cpu_count] : -1;
+    worker->poll_limit = workers->fragment_limit;
+    data->subscription = worker->subscription;
+    data->clock = *workers->clock;
+    message_dispatcher_init(&data->dispatcher, data);
+    message_dispatcher_register(&data->dispatcher, NMS_OPRA_TRADE_TYPE, trade_handler);
+    message_dispatcher_register(&data->dispatcher, NMS_OPRA_QUOTE_TYPE, quote_handler);
+
+    if (sequence_tracker_init(&data->sequence_tracker) < 0)
+    {
+        fprintf(stderr, "sequence_tracker_init: %s\n", aeron_errmsg());
+        return -1;
+    }
+
+    if (workers->record_latency)
+    {
+        if (histogram_init(&worker->latency_histogram, DEFAULT_HISTOGRAM_HIGHEST_TRACKABLE_VALUE, DEFAULT_HISTOGRAM_SIGNIFICANT_FIGURES) < 0)
+        {
+            fprintf(stderr, "histogram_init: %s\n", aeron_errmsg());
+            return -1;
+        }
+        data->latency_histogram = &worker->latency_histogram;
+    }
+
+    if (POLL_MODE_ASSEMBLER == workers->poll_mode && aeron_fragment_assembler_create(&worker->fragment_assembler, poll_handler, data) < 0)
+    {
+        fprintf(stderr, "aeron_fragment_assembler_create: %s\n", aeron_errmsg());
+        return -1;
+    }
+
+    if (idle_strategy_init(&worker->idle_strategy, workers->idle_strategy_spec) < 0)
+    {
+        return -1;
+    }
+
+    if (NULL != workers->rate_reporter)
+        data->rate_reporter_writer = rate_reporter_writer(workers->rate_reporter, worker->index);
+
+    if (pthread_create(&worker->thread, NULL, image_worker_run, worker) != 0)
+    {
+        fprintf(stderr, "pthread_create failed for image %zu\n", worker->index);
+        return -1;
+    }
+    worker->started = true;
+
+    return 0;
+}
+
+/*
+ * Starts a thread for every image as it arrives until the message limit, the idle timeout or a signal, then
+ * stops and joins them all. Received counts are summed once a millisecond, off every receive path.
+ */
+static int image_workers_run(image_workers_t *workers, uint64_t limit, uint64_t idle_timeout_ns)
+{
+    idle_strategy_t idle_strategy = {0};
+    uint64_t last_received = 0;
+    int64_t idle_since_ns = 0;
+    int result = 0;
+
+    if (idle_strategy_init(&idle_strategy, "sleeping:1ms") < 0)
+    {
+        return -1;
+    }
+
+    while (is_running())
+    {
+        size_t count;
+        uint64_t received = 0;
+
+        AERON_GET_VOLATILE(count, workers->count);
+        while (workers->started < count)
+        {
+            if (image_worker_start(workers, &workers->workers[workers->started++]) < 0)
+            {
+                result = -1;
+                break;
+            }
+        }
+        if (result < 0)
+            break;
+
+        for (size_t i = 0; i < workers->started; i++)
+        {
+            uint64_t worker_received;
+            AERON_GET_VOLATILE(worker_received, workers->workers[i].received);
+            received += worker_received;
+        }
+
+        if (limit != 0 && received >= limit)
+            break;
+
+        if (idle_timeout_ns != 0 && received > 0)
+        {
+            int64_t now_ns = aeron_nano_clock();
+            if (received != last_received)
+            {
+                last_received = received;
+                idle_since_ns = now_ns;
+            }
+            else if (now_ns - idle_since_ns >= (int64_t)idle_timeout_ns)
+            {
+                printf("No messages for %" PRIu64 "ms, stopping.\n", idle_timeout_ns / (1000 * 1000));
+                break;
+            }
+        }
+
+        idle_strategy_idle(&idle_strategy, 0);
+    }
+
+    sigint_handler(0);
+    for (size_t i = 0; i < workers->started; i++)
+    {
+        if (workers->workers[i].started)
+            pthread_join(workers->workers[i].thread, NULL);
+    }
+    idle_strategy_close(&idle_strategy);
+
+    return result;
+}
+
+/* Before the subscription is closed, an image that never got its thread is still retained here. */
+static void image_workers_release(image_workers_t *workers)
+{
+    size_t count;
+
+    if (NULL == workers->workers)
+        return;
+
+    AERON_GET_VOLATILE(count, workers->count);
+    for (size_t i = 0; i < count; i++)
+    {
+        image_worker_t *worker = &workers->workers[i];
+        if (!worker->started && NULL != worker->image)
+        {
+            aeron_subscription_image_release(worker->subscription, worker->image);
+            worker->image = NULL;
+        }
+    }
+}
+
+/* After the client is closed, when no image can be handed over any more. */
+static void image_workers_close(image_workers_t *workers)
+{
+    if (NULL == workers->workers)
+        return;
+
+    for (size_t i = 0; i < workers->capacity; i++)
+    {
+        image_worker_t *worker = &workers->workers[i];
+        aeron_fragment_assembler_delete(worker->fragment_assembler);
+        histogram_close(&worker->latency_histogram);
+        sequence_tracker_close(&worker->data.sequence_tracker);
+        idle_strategy_close(&worker->idle_strategy);
+        if (NULL != worker->perf_counters)
+            perf_counters_close(worker->perf_counters);
+    }
+
+    aeron_free(workers->workers);
+    aeron_free(workers->perf_counters);
+    workers->workers = NULL;
+    workers->perf_counters = NULL;
 }
 
 int main(int argc, char **argv)
@@ -106,23 +850,173 @@ int main(int argc, char **argv)
 
     const char *channel = DEFAULT_CHANNEL;
     const char *aeron_dir = NULL;
-    const uint64_t idle_duration_ns = UINT64_C(1000) * UINT64_C(1000); /* 1ms */
+    bool use_embedded_driver = false;
+    aeron_threading_mode_t driver_threading_mode = AERON_THREADING_MODE_DEDICATED;
+    const char *driver_idle_strategy = NULL;
+    embedded_driver_t driver = {0};
+    const char *idle_strategy_spec = "busy-spin";
+    int poll_cpus[AFFINITY_MAX_CPUS];
+    int poll_cpu = -1, poll_cpu_count = 0, reporter_cpu = -1, numa_node = -1;
+    idle_strategy_t idle_strategy = {0};
     int32_t stream_id = DEFAULT_STREAM_ID;
+    uint64_t fragment_limit = DEFAULT_FRAGMENT_COUNT_LIMIT;
+    uint64_t max_fragment_limit = DEFAULT_MAX_FRAGMENT_COUNT_LIMIT;
+    bool adaptive_fragment_limit = false;
+    uint64_t block_length_limit = DEFAULT_BLOCK_LENGTH_LIMIT;
+    poll_mode_t poll_mode = POLL_MODE_ASSEMBLER;
+    uint64_t image_thread_limit = 0;
+    image_workers_t image_workers = {0};
+    bool print_json = false;
+    bool export_counters = false;
+    bench_counters_t counters = {0};
+    bool measure_perf = false;
+    perf_counters_t perf_counters = {0};
+    perf_counter_set_t perf_set = {.counters = &perf_counters, .count = 1};
+    const char *clock_spec = "auto";
+    bool report_clock_read_cost = false;
+    double clock_read_ns = 0.0;
+    perf_counter_values_t perf_start = {0}, perf_idle = {0}, perf_values = {0};
+    bool perf_stopped_idle = false;
 
-    rate_reporter_t rate_reporter;
+    rate_reporter_t rate_reporter = {0};
     bool show_rate_progress = false;
 
+    histogram_t interval_latency_histogram = {0}, latency_histogram = {0};
+    bool record_latency = false;
+    const int64_t latency_report_interval_ns = INT64_C(1000) * INT64_C(1000) * INT64_C(1000); /* 1s */
+    uint64_t idle_timeout_ns = 0;
+    double steady_state_tolerance = 0.0;
+    steady_state_t steady_state;
+
+    top_of_book_t top_of_book = {0};
+    uint64_t top_of_book_contracts = 0;
+
+    const char *journal_path = NULL;
+    uint64_t journal_segment_length = DEFAULT_CAPTURE_SEGMENT_LENGTH;
+    capture_writer_t journal = {.fd = -1};
+
     handler_data_t data = {
         .limit = DEFAULT_NUMBER_OF_MESSAGES,
     };
 
-    while ((opt = getopt(argc, argv, "hvPc:m:p:s:")) != -1)
-    {
-        switch (opt)
+    while ((opt = getopt(argc, argv, "hvEJKLOPa:b:B:c:C:D:f:g:G:i:I:m:M:N:o:p:s:S:T:W:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'a':
+        {
+            if ((poll_cpu_count = affinity_parse_cpu_list(optarg, poll_cpus, AFFINITY_MAX_CPUS)) <= 0)
+            {
+                fprintf(stderr, "malformed cpu list %s\n", optarg);
+                exit(status);
+            }
+            poll_cpu = poll_cpus[0];
+            break;
+        }
+
+        case 'C':
+        {
+            if (affinity_parse_cpu_list(optarg, &reporter_cpu, 1) != 1)
+            {
+                fprintf(stderr, "malformed cpu %s\n", optarg);
+                exit(status);
+            }
+            break;
+        }
+
+        case 'N':
+        {
+            char *end = NULL;
+            long node = strtol(optarg, &end, 10);
+            if (end == optarg || *end != '\0' || node < 0 || node > INT32_MAX)
+            {
+                fprintf(stderr, "malformed NUMA node %s\n", optarg);
+                exit(status);
+            }
+            numa_node = (int)node;
+            break;
+        }
+
+        case 'B':
+        {
+            if (feed_generator_parse_contracts(optarg, &top_of_book_contracts) < 0)
+            {
+                fprintf(stderr, "malformed number of contracts %s\n", optarg);
+                exit(status);
+            }
+            break;
+        }
+
+        case 'W':
+        {
+            journal_path = optarg;
+            break;
+        }
+
+        case 'g':
+        {
+            if (aeron_parse_size64(optarg, &journal_segment_length) < 0)
+            {
+                fprintf(stderr, "malformed journal segment length %s: %s\n", optarg, aeron_errmsg());
+                exit(status);
+            }
+            break;
+        }
+
+        case 'c':
+        {
+            channel = optarg;
+            break;
+        }
+
+        case 'f':
+        {
+            if (strncmp(optarg, "adaptive", 8) == 0 && (optarg[8] == '\0' || optarg[8] == ':'))
+            {
+                adaptive_fragment_limit = true;
+                if (optarg[8] == ':' &&
+                    (aeron_parse_size64(optarg + 9, &max_fragment_limit) < 0 || max_fragment_limit == 0 ||
+                     max_fragment_limit > INT32_MAX))
+                {
+                    fprintf(stderr, "malformed adaptive fragment count limit %s\n", optarg);
+                    exit(status);
+                }
+            }
+            else if (aeron_parse_size64(optarg, &fragment_limit) < 0 || fragment_limit == 0 || fragment_limit > INT32_MAX)
+            {
+                fprintf(stderr, "malformed fragment count limit %s: %s\n", optarg, aeron_errmsg());
+                exit(status);
+            }
+            break;
+        }
+
+        case 'G':
+        {
+            if (aeron_parse_size64(optarg, &image_thread_limit) < 0 || image_thread_limit == 0 || image_thread_limit > IMAGE_WORKERS_MAX)
+            {
+                fprintf(stderr, "malformed number of images %s, expected 1 to %d\n", optarg, IMAGE_WORKERS_MAX);
+                exit(status);
+            }
+            break;
+        }
+
+        case 'M':
         {
-        case 'c':
+            if (parse_poll_mode(optarg, &poll_mode) < 0)
+            {
+                fprintf(stderr, "malformed poll mode %s, expected assembler, poll, controlled or block\n", optarg);
+                exit(status);
+            }
+            break;
+        }
+
+        case 'b':
         {
-            channel = optarg;
+            if (aeron_parse_size64(optarg, &block_length_limit) < 0 || block_length_limit == 0 || block_length_limit > INT32_MAX)
+            {
+                fprintf(stderr, "malformed block length limit %s: %s\n", optarg, aeron_errmsg());
+                exit(status);
+            }
             break;
         }
 
@@ -136,9 +1030,53 @@ int main(int argc, char **argv)
             break;
         }
 
+        case 'L':
+        {
+            record_latency = true;
+            break;
+        }
+
         case 'P':
         {
+#if BENCH_INSTRUMENTATION == BENCH_INSTRUMENTATION_NONE
+            fprintf(stderr, "-P ignored, built with INSTRUMENTATION=0\n");
+#else
             show_rate_progress = true;
+#endif
+            break;
+        }
+
+        case 'J':
+        {
+            print_json = true;
+            break;
+        }
+
+        case 'E':
+        {
+            measure_perf = true;
+            break;
+        }
+
+        case 'O':
+        {
+            report_clock_read_cost = true;
+            break;
+        }
+
+        case 'o':
+        {
+            clock_spec = optarg;
+            break;
+        }
+
+        case 'K':
+        {
+#if BENCH_INSTRUMENTATION == BENCH_INSTRUMENTATION_NONE
+            fprintf(stderr, "-K ignored, built with INSTRUMENTATION=0\n");
+#else
+            export_counters = true;
+#endif
             break;
         }
 
@@ -148,12 +1086,57 @@ int main(int argc, char **argv)
             break;
         }
 
+        case 'D':
+        {
+            if (embedded_driver_parse_threading_mode(optarg, &driver_threading_mode) < 0)
+            {
+                fprintf(stderr, "malformed threading mode %s, expected dedicated, shared-network or shared\n", optarg);
+                exit(status);
+            }
+            use_embedded_driver = true;
+            break;
+        }
+
+        case 'I':
+        {
+            driver_idle_strategy = optarg;
+            break;
+        }
+
+        case 'i':
+        {
+            idle_strategy_spec = optarg;
+            break;
+        }
+
         case 's':
         {
             stream_id = (int32_t)strtoul(optarg, NULL, 0);
             break;
         }
 
+        case 'S':
+        {
+            char *end = NULL;
+            steady_state_tolerance = strtod(optarg, &end);
+            if (end == optarg || *end != '\0' || steady_state_tolerance <= 0.0 || steady_state_tolerance >= 1.0)
+            {
+                fprintf(stderr, "malformed steady state tolerance %s, expected between 0 and 1\n", optarg);
+                exit(status);
+            }
+            break;
+        }
+
+        case 'T':
+        {
+            if (aeron_parse_duration_ns(optarg, &idle_timeout_ns) < 0)
+            {
+                fprintf(stderr, "malformed idle timeout %s: %s\n", optarg, aeron_errmsg());
+                exit(status);
+            }
+            break;
+        }
+
         case 'v':
         {
             printf(
@@ -174,6 +1157,19 @@ int main(int argc, char **argv)
         }
     }
 
+    if (adaptive_fragment_limit && max_fragment_limit < fragment_limit)
+    {
+        fprintf(stderr, "adaptive fragment count limit %" PRIu64 " below the initial limit %" PRIu64 "\n", max_fragment_limit, fragment_limit);
+        exit(status);
+    }
+
+    // the book, the journal, the counters and the rate check follow a single polling thread
+    if (image_thread_limit > 0 && (top_of_book_contracts > 0 || NULL != journal_path || export_counters || steady_state_tolerance > 0.0))
+    {
+        fprintf(stderr, "-G does not go with -B, -K, -S or -W\n");
+        exit(status);
+    }
+
     signal(SIGINT, sigint_handler);
 
     printf("Subscribing for %" PRIu64 " messages to %s on stream id %" PRId32 "\n",
@@ -183,6 +1179,42 @@ int main(int argc, char **argv)
     aeron_t *aeron = NULL;
     aeron_async_add_subscription_t *async = NULL;
     aeron_fragment_assembler_t *fragment_assembler = NULL;
+
+    message_dispatcher_init(&data.dispatcher, &data);
+    message_dispatcher_register(&data.dispatcher, NMS_OPRA_TRADE_TYPE, trade_handler);
+    message_dispatcher_register(&data.dispatcher, NMS_OPRA_QUOTE_TYPE, quote_handler);
+
+    if (idle_strategy_init(&idle_strategy, idle_strategy_spec) < 0)
+    {
+        goto cleanup;
+    }
+
+    // before anything is allocated or started, every thread and buffer after this follows the node
+    if (affinity_bind_current_thread_to_node(numa_node) < 0)
+    {
+        goto cleanup;
+    }
+    for (int i = 0; numa_node >= 0 && i < poll_cpu_count; i++)
+    {
+        if (affinity_cpu_node(poll_cpus[i]) != numa_node)
+            fprintf(stderr, "warning: cpu %d is on node %d, not node %d\n", poll_cpus[i], affinity_cpu_node(poll_cpus[i]), numa_node);
+    }
+
+    if (sequence_tracker_init(&data.sequence_tracker) < 0)
+    {
+        fprintf(stderr, "sequence_tracker_init: %s\n", aeron_errmsg());
+        goto cleanup;
+    }
+
+    if (use_embedded_driver)
+    {
+        if (embedded_driver_start(&driver, aeron_dir, driver_threading_mode, driver_idle_strategy) < 0)
+        {
+            goto cleanup;
+        }
+        aeron_dir = embedded_driver_dir(&driver);
+    }
+
     if (aeron_context_init(&context) < 0)
     {
         fprintf(stderr, "aeron_context_init: %s\n", aeron_errmsg());
@@ -210,15 +1242,36 @@ int main(int argc, char **argv)
         goto cleanup;
     }
 
+    // the slots are there before the subscription, an image can be reported as soon as it is added
+    if (image_thread_limit > 0)
+    {
+        if (image_workers_init(&image_workers, (size_t)image_thread_limit, measure_perf) < 0)
+        {
+            goto cleanup;
+        }
+        image_workers.poll_mode = poll_mode;
+        image_workers.fragment_limit = (size_t)fragment_limit;
+        image_workers.max_fragment_limit = (size_t)max_fragment_limit;
+        image_workers.adaptive_fragment_limit = adaptive_fragment_limit;
+        image_workers.block_length_limit = (size_t)block_length_limit;
+        image_workers.idle_strategy_spec = idle_strategy_spec;
+        image_workers.record_latency = record_latency;
+        image_workers.clock = &data.clock;
+        image_workers.cpus = poll_cpus;
+        image_workers.cpu_count = poll_cpu_count;
+        perf_set.counters = image_workers.perf_counters;
+        perf_set.count = image_workers.capacity;
+    }
+
     if (aeron_async_add_subscription(
             &async,
             aeron,
             channel,
             stream_id,
-            print_available_image,
-            NULL,
-            print_unavailable_image,
-            NULL) < 0)
+            image_thread_limit > 0 ? image_worker_on_available : print_available_image,
+            image_thread_limit > 0 ? &image_workers : NULL,
+            image_thread_limit > 0 ? image_worker_on_unavailable : print_unavailable_image,
+            image_thread_limit > 0 ? &image_workers : NULL) < 0)
     {
         fprintf(stderr, "aeron_async_add_subscription: %s\n", aeron_errmsg());
         goto cleanup;
@@ -237,7 +1290,7 @@ int main(int argc, char **argv)
 
     printf("Subscription channel status %" PRIu64 "\n", aeron_subscription_channel_status(data.subscription));
 
-    if (aeron_fragment_assembler_create(&fragment_assembler, poll_handler, &data) < 0)
+    if (POLL_MODE_ASSEMBLER == poll_mode && 0 == image_thread_limit && aeron_fragment_assembler_create(&fragment_assembler, poll_handler, &data) < 0)
     {
         fprintf(stderr, "aeron_fragment_assembler_create: %s\n", aeron_errmsg());
         goto cleanup;
@@ -245,62 +1298,617 @@ int main(int argc, char **argv)
 
     if (show_rate_progress)
     {
-        if (rate_reporter_start(&rate_reporter, print_rate_report) < 0)
+        // the counters are only opened on the polling thread below, until then the interval reads find them not ready
+        if (measure_perf)
+            rate_reporter_set_on_interval(&rate_reporter, perf_counter_set_on_interval, &perf_set);
+
+        // every image thread owns a writer slot, the single polling thread the reporter's own
+        if ((image_thread_limit > 0 ?
+                rate_reporter_start_writers(&rate_reporter, print_rate_report, image_workers.capacity) :
+                rate_reporter_start(&rate_reporter, print_rate_report)) < 0)
         {
             fprintf(stderr, "rate_reporter_start: %s\n", aeron_errmsg());
             goto cleanup;
         }
-        data.rate_reporter = &rate_reporter;
+        data.rate_reporter_writer = rate_reporter_writer(&rate_reporter, 0);
+        image_workers.rate_reporter = &rate_reporter;
+
+        if (reporter_cpu >= 0)
+        {
+            if (affinity_pin_thread(rate_reporter.runner.thread, reporter_cpu) < 0)
+            {
+                goto cleanup;
+            }
+            printf("Rate reporter: cpu %d node %d\n", reporter_cpu, affinity_cpu_node(reporter_cpu));
+        }
+    }
+
+    if (record_latency)
+    {
+        if (histogram_init(&latency_histogram, DEFAULT_HISTOGRAM_HIGHEST_TRACKABLE_VALUE, DEFAULT_HISTOGRAM_SIGNIFICANT_FIGURES) < 0 ||
+            histogram_init(&interval_latency_histogram, DEFAULT_HISTOGRAM_HIGHEST_TRACKABLE_VALUE, DEFAULT_HISTOGRAM_SIGNIFICANT_FIGURES) < 0)
+        {
+            fprintf(stderr, "histogram_init: %s\n", aeron_errmsg());
+            goto cleanup;
+        }
+        data.latency_histogram = &interval_latency_histogram;
+    }
+
+    if (top_of_book_contracts > 0)
+    {
+        if (top_of_book_init(&top_of_book, top_of_book_contracts) < 0)
+        {
+            fprintf(stderr, "top_of_book_init: %s\n", aeron_errmsg());
+            goto cleanup;
+        }
+        data.top_of_book = &top_of_book;
+        printf("Top of book table %.04g MB on node %d\n",
+               (double)top_of_book_memory_footprint(&top_of_book) / (double)(1024 * 1024),
+               affinity_address_node(top_of_book.entries));
+    }
+
+    if (NULL != journal_path)
+    {
+        if (capture_writer_open(&journal, journal_path, (size_t)journal_segment_length) < 0)
+        {
+            goto cleanup;
+        }
+        data.journal = &journal;
+        printf("Journaling to %s in %" PRIu64 " MB segments\n", journal_path, journal_segment_length / (1024 * 1024));
+    }
+
+    if (export_counters)
+    {
+        static const bench_counter_kind_t kinds[] = {
+            BENCH_COUNTER_MESSAGES, BENCH_COUNTER_BYTES, BENCH_COUNTER_GAPS, BENCH_COUNTER_LOST, BENCH_COUNTER_MALFORMED,
+            BENCH_COUNTER_LATENCY_P50_NS, BENCH_COUNTER_LATENCY_P99_NS, BENCH_COUNTER_LATENCY_P99_9_NS, BENCH_COUNTER_LATENCY_MAX_NS};
+        // the latency kinds are last, they are only added when latency is recorded
+        size_t kind_count = sizeof(kinds) / sizeof(kinds[0]) - (record_latency ? 0 : 4);
+
+        if (bench_counters_init(&counters, aeron, "sub", stream_id, 0, kinds, kind_count) < 0)
+        {
+            goto cleanup;
+        }
+        printf("Counters %" PRId32 "-%" PRId32 "\n", counters.first_counter_id, counters.last_counter_id);
+    }
+
+    // pinned last, the client conductor and driver threads inherited the affinity when they were started;
+    // with a thread per image the main thread only watches them, and each image thread pins itself
+    if (0 == image_thread_limit)
+    {
+        if (affinity_pin_current_thread(poll_cpu) < 0)
+        {
+            goto cleanup;
+        }
+        affinity_print_placement("Poll");
+    }
+
+    if (bench_clock_init(&data.clock, clock_spec) < 0)
+    {
+        goto cleanup;
+    }
+    if (report_clock_read_cost)
+    {
+        clock_read_ns = bench_clock_print_read_cost(&data.clock);
+    }
+
+    if (image_thread_limit > 0)
+    {
+        int64_t process_cpu_start_ns = cpu_time_process_ns();
+
+        if (image_workers_run(&image_workers, data.limit, idle_timeout_ns) < 0)
+        {
+            goto cleanup;
+        }
+        int64_t process_cpu_ns = cpu_time_process_ns() - process_cpu_start_ns;
+
+        printf("Done receiving.\n");
+
+        if (show_rate_progress)
+        {
+            rate_reporter_flush(&rate_reporter);
+            rate_reporter_halt(&rate_reporter);
+        }
+
+        uint64_t messages = 0, bytes = 0, lost = 0, warm_up_messages = 0, malformed_fragments = 0, fragmented_frames = 0;
+        uint64_t polls = 0, empty_polls = 0, read_total = 0, trade_volume = 0, trade_notional = 0, quote_spread_sum = 0, crossed_quotes = 0;
+        int64_t start_timestamp_ns = INT64_MAX, end_timestamp_ns = 0, cpu_time_ns = 0;
+        size_t closed_images = 0;
+        perf_counter_values_t image_perf_values = {0};
+
+        for (size_t i = 0; i < image_workers.started; i++)
+        {
+            image_worker_t *worker = &image_workers.workers[i];
+            const handler_data_t *image_data = &worker->data;
+            int64_t image_duration_ns = worker->start_timestamp_ns != 0 ? worker->end_timestamp_ns - worker->start_timestamp_ns : 0;
+            char label[64];
+
+            printf(
+                "Image %zu cpu %d session %" PRId32 " from %s%s: %" PRIu64 " messages, %.04g msgs/sec, %.04g bytes/sec, lost %" PRIu64 ", "
+                "cpu time %.3f ms (%.2f cores)\n",
+                i,
+                worker->cpu,
+                worker->session_id,
+                worker->source_identity,
+                worker->closed ? ", closed" : "",
+                image_data->messages,
+                image_duration_ns > 0 ? (double)image_data->messages * (double)(1000 * 1000 * 1000) / (double)image_duration_ns : 0.0,
+                image_duration_ns > 0 ? (double)image_data->bytes * (double)(1000 * 1000 * 1000) / (double)image_duration_ns : 0.0,
+                sequence_tracker_lost(&image_data->sequence_tracker),
+                (double)worker->cpu_time_ns / (1000.0 * 1000.0),
+                cpu_time_cores(worker->cpu_time_ns, image_duration_ns));
+            sequence_tracker_print_report(&image_data->sequence_tracker);
+
+            if (record_latency)
+            {
+                snprintf(label, sizeof(label), "Image %zu", i);
+                print_latency_report(label, &worker->latency_histogram);
+                histogram_add(&latency_histogram, &worker->latency_histogram);
+            }
+
+            if (measure_perf)
+            {
+                snprintf(label, sizeof(label), "Image %zu perf", i);
+                perf_counters_print(label, &worker->perf_values, image_data->messages);
+                perf_counter_values_add(&image_perf_values, &worker->perf_values);
+            }
+
+            bench_clock_add_checks(&data.clock, &image_data->clock);
+            messages += image_data->messages;
+            bytes += image_data->bytes;
+            lost += sequence_tracker_lost(&image_data->sequence_tracker);
+            warm_up_messages += image_data->warm_up_messages;
+            malformed_fragments += image_data->malformed_fragments;
+            fragmented_frames += image_data->fragmented_frames;
+            trade_volume += image_data->trade_volume;
+            trade_notional += image_data->trade_notional;
+            quote_spread_sum += image_data->quote_spread_sum;
+            crossed_quotes += image_data->crossed_quotes;
+            polls += worker->polls;
+            empty_polls += worker->empty_polls;
+            read_total += worker->read_total;
+            cpu_time_ns += worker->cpu_time_ns;
+            if (worker->closed)
+                closed_images++;
+            if (worker->start_timestamp_ns != 0 && worker->start_timestamp_ns < start_timestamp_ns)
+                start_timestamp_ns = worker->start_timestamp_ns;
+            if (worker->start_timestamp_ns != 0 && worker->end_timestamp_ns > end_timestamp_ns)
+                end_timestamp_ns = worker->end_timestamp_ns;
+        }
+
+        // the run spans every image, from the first message of any to the last of any
+        int64_t image_duration_ns = end_timestamp_ns > start_timestamp_ns ? end_timestamp_ns - start_timestamp_ns : 0;
+        uint64_t ignored_images;
+        AERON_GET_VOLATILE(ignored_images, image_workers.ignored);
+
+        printf("Images: %zu polled on threads of their own, %zu closed during the run", image_workers.started, closed_images);
+        if (ignored_images > 0)
+            printf(", %" PRIu64 " not polled with all %zu threads taken", ignored_images, image_workers.capacity);
+        printf("\n");
+        printf(
+            "Total: %" PRId64 "ms, %.04g msgs/sec, %.04g bytes/sec, totals %" PRIu64 " messages %.04g MB payloads\n",
+            image_duration_ns / (1000 * 1000),
+            image_duration_ns > 0 ? (double)messages * (double)(1000 * 1000 * 1000) / (double)image_duration_ns : 0.0,
+            image_duration_ns > 0 ? (double)bytes * (double)(1000 * 1000 * 1000) / (double)image_duration_ns : 0.0,
+            messages,
+            (double)bytes / (double)(1024 * 1024));
+        printf("CPU: image threads %.3f ms (%.2f cores) idling with %s, process %.3f ms (%.2f cores)\n",
+               (double)cpu_time_ns / (1000.0 * 1000.0),
+               cpu_time_cores(cpu_time_ns, image_duration_ns),
+               idle_strategy_spec,
+               (double)process_cpu_ns / (1000.0 * 1000.0),
+               cpu_time_cores(process_cpu_ns, image_duration_ns));
+        if (measure_perf)
+        {
+            perf_counters_print("Perf", &image_perf_values, messages);
+        }
+        bench_clock_print_report(&data.clock);
+        if (warm_up_messages > 0)
+        {
+            printf("Warm-up: %" PRIu64 " messages excluded\n", warm_up_messages);
+        }
+        if (malformed_fragments > 0)
+        {
+            printf("Malformed fragments %" PRIu64 "\n", malformed_fragments);
+        }
+        if (fragmented_frames > 0)
+        {
+            printf("Fragments of larger messages dropped without an assembler %" PRIu64 "\n", fragmented_frames);
+        }
+        printf("Polls: %s, %" PRIu64 " polls, %.1f%% empty, %.1f %s per poll with data\n",
+               poll_mode_names[poll_mode],
+               polls,
+               polls > 0 ? 100.0 * (double)empty_polls / (double)polls : 0.0,
+               polls > empty_polls ? (double)read_total / (double)(polls - empty_polls) : 0.0,
+               POLL_MODE_BLOCK == poll_mode ? "bytes" : "fragments");
+        printf(
+            "Decoded trade volume %" PRIu64 " notional %" PRIu64 ", quote spread sum %" PRIu64 " crossed %" PRIu64 "\n",
+            trade_volume,
+            trade_notional,
+            quote_spread_sum,
+            crossed_quotes);
+
+        if (record_latency)
+        {
+            print_latency_report("Total", &latency_histogram);
+        }
+
+        if (print_json)
+        {
+            json_report_t report;
+            json_report_begin(&report, stdout, "sub");
+            json_report_string(&report, "channel", channel);
+            json_report_int(&report, "stream_id", stream_id);
+            json_report_string(&report, "poll_mode", poll_mode_names[poll_mode]);
+            json_report_uint(&report, "fragment_limit", fragment_limit);
+            if (POLL_MODE_BLOCK == poll_mode)
+                json_report_uint(&report, "block_length_limit", block_length_limit);
+            json_report_uint(&report, "images", image_workers.started);
+            json_report_uint(&report, "images_closed", closed_images);
+            json_report_uint(&report, "images_not_polled", ignored_images);
+            json_report_uint(&report, "polls", polls);
+            json_report_uint(&report, "empty_polls", empty_polls);
+            json_report_uint(&report, "fragmented_frames", fragmented_frames);
+            json_report_int(&report, "duration_ns", image_duration_ns);
+            json_report_uint(&report, "messages", messages);
+            json_report_uint(&report, "bytes", bytes);
+            json_report_double(&report, "msgs_per_sec", image_duration_ns > 0 ? (double)messages * (double)(1000 * 1000 * 1000) / (double)image_duration_ns : 0.0);
+            json_report_double(&report, "bytes_per_sec", image_duration_ns > 0 ? (double)bytes * (double)(1000 * 1000 * 1000) / (double)image_duration_ns : 0.0);
+            json_report_uint(&report, "lost", lost);
+            json_report_uint(&report, "warm_up_messages", warm_up_messages);
+            json_report_uint(&report, "malformed_fragments", malformed_fragments);
+            json_report_string(&report, "idle", idle_strategy_spec);
+            json_report_string(&report, "instrumentation", BENCH_INSTRUMENTATION_NAME);
+            json_report_string(&report, "clock", data.clock.name);
+            json_report_int(&report, "clock_max_drift_ns", data.clock.max_drift_ns);
+            if (report_clock_read_cost)
+                json_report_double(&report, "clock_read_ns", clock_read_ns);
+            json_report_int(&report, "cpu_time_ns", cpu_time_ns);
+            json_report_double(&report, "cpu_cores", cpu_time_cores(cpu_time_ns, image_duration_ns));
+            json_report_int(&report, "process_cpu_time_ns", process_cpu_ns);
+            if (record_latency)
+                json_report_histogram(&report, "latency", &latency_histogram);
+            if (measure_perf)
+                json_report_perf_counters(&report, "perf", &image_perf_values, messages);
+
+            // per image keys are numbered by the order the images arrived in
+            for (size_t i = 0; i < image_workers.started; i++)
+            {
+                const image_worker_t *worker = &image_workers.workers[i];
+                int64_t worker_duration_ns = worker->start_timestamp_ns != 0 ? worker->end_timestamp_ns - worker->start_timestamp_ns : 0;
+                char key[64];
+
+                snprintf(key, sizeof(key), "image_%zu_session_id", i);
+                json_report_int(&report, key, worker->session_id);
+                snprintf(key, sizeof(key), "image_%zu_messages", i);
+                json_report_uint(&report, key, worker->data.messages);
+                snprintf(key, sizeof(key), "image_%zu_duration_ns", i);
+                json_report_int(&report, key, worker_duration_ns);
+                snprintf(key, sizeof(key), "image_%zu_msgs_per_sec", i);
+                json_report_double(&report, key, worker_duration_ns > 0 ? (double)worker->data.messages * (double)(1000 * 1000 * 1000) / (double)worker_duration_ns : 0.0);
+                snprintf(key, sizeof(key), "image_%zu_lost", i);
+                json_report_uint(&report, key, sequence_tracker_lost(&worker->data.sequence_tracker));
+                snprintf(key, sizeof(key), "image_%zu_cpu_time_ns", i);
+                json_report_int(&report, key, worker->cpu_time_ns);
+                if (record_latency)
+                {
+                    snprintf(key, sizeof(key), "image_%zu_latency", i);
+                    json_report_histogram(&report, key, &worker->latency_histogram);
+                }
+            }
+            json_report_end(&report);
+        }
+
+        status = EXIT_SUCCESS;
+        goto cleanup;
     }
 
+    if (measure_perf)
+        perf_counters_open(&perf_counters);
+
     uint64_t back_pressure_count = 0, message_sent_count = 0;
     int64_t start_timestamp_ns = 0;
     int64_t duration_ns;
+    int64_t next_latency_report_ns = 0;
+    int64_t idle_since_ns = 0;
+    int64_t cpu_start_ns = cpu_time_thread_ns(), process_cpu_start_ns = cpu_time_process_ns();
+    int64_t wall_start_ns = bench_clock_ns(&data.clock);
+    uint64_t poll_count = 0, steady_state_poll_count = 0;
+    uint64_t polls = 0, empty_polls = 0, read_total = 0;
+    size_t poll_limit = (size_t)fragment_limit;
+    steady_state_init(&steady_state, steady_state_tolerance);
 
     while (is_running())
     {
-        int fragments_read = aeron_subscription_poll(
-            data.subscription, aeron_fragment_assembler_handler, fragment_assembler, DEFAULT_FRAGMENT_COUNT_LIMIT);
+        // fragments read, bytes in block mode
+        int fragments_read;
+        switch (poll_mode)
+        {
+        case POLL_MODE_POLL:
+            fragments_read = aeron_subscription_poll(data.subscription, unassembled_poll_handler, &data, poll_limit);
+            break;
+
+        case POLL_MODE_CONTROLLED:
+            fragments_read = aeron_subscription_controlled_poll(data.subscription, controlled_poll_handler, &data, poll_limit);
+            break;
+
+        case POLL_MODE_BLOCK:
+            fragments_read = (int)aeron_subscription_block_poll(data.subscription, block_poll_handler, &data, (size_t)block_length_limit);
+            break;
+
+        default:
+            fragments_read = aeron_subscription_poll(data.subscription, aeron_fragment_assembler_handler, fragment_assembler, poll_limit);
+            break;
+        }
 
         if (fragments_read < 0)
         {
-            fprintf(stderr, "aeron_subscription_poll: %s\n", aeron_errmsg());
+            fprintf(stderr, "%s poll: %s\n", poll_mode_names[poll_mode], aeron_errmsg());
             goto cleanup;
         }
 
+        polls++;
+        read_total += (uint64_t)fragments_read;
+        if (fragments_read == 0)
+            empty_polls++;
+        if (adaptive_fragment_limit)
+            poll_limit = adapt_fragment_limit(poll_limit, fragments_read, (size_t)fragment_limit, (size_t)max_fragment_limit);
+
         if (start_timestamp_ns == 0 && fragments_read > 0)
-            start_timestamp_ns = aeron_nano_clock();
+        {
+            // the run is counted from the first message, not the wait for the publisher
+            if (measure_perf)
+                perf_counters_read(&perf_counters, &perf_start);
+            start_timestamp_ns = bench_clock_ns(&data.clock);
+            next_latency_report_ns = start_timestamp_ns + latency_report_interval_ns;
+        }
+
+        if (data.restart_measurement)
+        {
+            // warm-up is over, the run and its CPU time are counted again from here
+            data.restart_measurement = false;
+            if (measure_perf)
+                perf_counters_read(&perf_counters, &perf_start);
+            start_timestamp_ns = wall_start_ns = bench_clock_ns(&data.clock);
+            next_latency_report_ns = start_timestamp_ns + latency_report_interval_ns;
+            cpu_start_ns = cpu_time_thread_ns();
+            process_cpu_start_ns = cpu_time_process_ns();
+            if (record_latency)
+                histogram_reset(&latency_histogram);
+        }
+
+        // a sleeping or backing off idle strategy polls rarely, so an idle poll always looks at the clock
+        if (steady_state_tolerance > 0.0 && start_timestamp_ns != 0 && !steady_state.steady &&
+            (fragments_read == 0 || (++steady_state_poll_count & (STEADY_STATE_CHECK_POLLS - 1)) == 0) &&
+            steady_state_on_progress(&steady_state, bench_clock_ns(&data.clock), data.messages))
+        {
+            // unlike flagged warm-up frames these were part of the messages asked for, the limit shrinks with them
+            uint64_t excluded = data.messages + sequence_tracker_lost(&data.sequence_tracker);
+            if (data.limit != 0)
+                data.limit = data.limit > excluded ? data.limit - excluded : 1;
+            reset_statistics(&data);
+        }
+
+        // the clock is only read while idle, so the receive path pays nothing for the timeout
+        if (fragments_read > 0)
+        {
+            idle_since_ns = 0;
+        }
+        else
+        {
+            // an empty poll is when a partial batch of progress totals is published
+            if (show_rate_progress)
+                rate_reporter_flush(&rate_reporter);
+
+            if (idle_timeout_ns != 0 && start_timestamp_ns != 0)
+            {
+                int64_t now_ns = bench_clock_ns(&data.clock);
+                if (idle_since_ns == 0)
+                {
+                    idle_since_ns = now_ns;
+                    if (measure_perf)
+                        perf_counters_read(&perf_counters, &perf_idle);
+                }
+                else if (now_ns - idle_since_ns >= (int64_t)idle_timeout_ns)
+                {
+                    printf("No messages for %" PRIu64 "ms, stopping.\n", idle_timeout_ns / (1000 * 1000));
+                    // nor the timeout spent spinning after the last one
+                    perf_stopped_idle = true;
+                    break;
+                }
+            }
+        }
+
+        if (record_latency && data.last_receive_timestamp_ns >= next_latency_report_ns && next_latency_report_ns != 0)
+        {
+            if (show_rate_progress)
+                print_latency_report("Interval", &interval_latency_histogram);
+
+            if (export_counters)
+                update_latency_counters(&counters, &interval_latency_histogram);
+
+            histogram_add(&latency_histogram, &interval_latency_histogram);
+            histogram_reset(&interval_latency_histogram);
+            next_latency_report_ns = data.last_receive_timestamp_ns + latency_report_interval_ns;
+        }
+
+        if (BENCH_INSTRUMENTATION != BENCH_INSTRUMENTATION_NONE && export_counters && (++poll_count & (BENCH_COUNTERS_UPDATE_INTERVAL - 1)) == 0)
+            update_counters(&counters, &data);
 
-        aeron_idle_strategy_busy_spinning_idle((void *)&idle_duration_ns, fragments_read);
+        idle_strategy_idle(&idle_strategy, fragments_read);
+    }
+    int64_t end_timestamp_ns = bench_clock_ns(&data.clock);
+    duration_ns = end_timestamp_ns - start_timestamp_ns;
+    // CPU time covers the wait for the first message too, so it is set against the whole polling time
+    int64_t cpu_time_ns = cpu_time_thread_ns() - cpu_start_ns;
+    int64_t process_cpu_ns = cpu_time_process_ns() - process_cpu_start_ns;
+    int64_t wall_ns = end_timestamp_ns - wall_start_ns;
+    if (measure_perf)
+    {
+        if (perf_stopped_idle)
+            perf_values = perf_idle;
+        else
+            perf_counters_read(&perf_counters, &perf_values);
+        perf_counter_values_sub(&perf_values, &perf_start);
     }
-    duration_ns = aeron_nano_clock() - start_timestamp_ns;
 
     printf("Done receiving.\n");
 
+    if (export_counters)
+        update_counters(&counters, &data);
+
     if (show_rate_progress)
     {
+        rate_reporter_flush(&rate_reporter);
         rate_reporter_halt(&rate_reporter);
     }
 
-    double avg_message_length = (double)sizeof(struct nms_opra_trade_t) + sizeof(struct nms_opra_quote_t) / 2.0;
     printf("Publisher back pressure ratio %g\n", (double)back_pressure_count / (double)message_sent_count);
     printf(
         "Total: %" PRId64 "ms, %.04g msgs/sec, %.04g bytes/sec, totals %" PRIu64 " messages %.04g MB payloads\n",
         duration_ns / (1000 * 1000),
         ((double)data.messages * (double)(1000 * 1000 * 1000) / (double)duration_ns),
-        ((double)(data.messages * avg_message_length) * (double)(1000 * 1000 * 1000) / (double)duration_ns),
+        ((double)data.bytes * (double)(1000 * 1000 * 1000) / (double)duration_ns),
         data.messages,
-        (double)data.messages * avg_message_length / (double)(1024 * 1024));
+        (double)data.bytes / (double)(1024 * 1024));
+
+    printf("CPU: poll thread %.3f ms (%.2f cores) idling with %s, process %.3f ms (%.2f cores)\n",
+           (double)cpu_time_ns / (1000.0 * 1000.0),
+           cpu_time_cores(cpu_time_ns, wall_ns),
+           idle_strategy_spec,
+           (double)process_cpu_ns / (1000.0 * 1000.0),
+           cpu_time_cores(process_cpu_ns, wall_ns));
+
+    if (measure_perf)
+    {
+        perf_counters_print("Perf", &perf_values, data.messages);
+    }
+    bench_clock_print_report(&data.clock);
+    if (data.warm_up_sources > 0)
+    {
+        printf("Warm-up: %" PRIu64 " messages excluded, %" PRIu32 " of %" PRIu32 " sources ended their warm-up\n",
+               data.warm_up_messages, data.warm_up_end_count, data.warm_up_sources);
+    }
+    if (steady_state_tolerance > 0.0)
+    {
+        steady_state_print_report(&steady_state);
+    }
+
+    if (data.malformed_fragments > 0)
+    {
+        printf("Malformed fragments %" PRIu64 "\n", data.malformed_fragments);
+    }
+    if (data.fragmented_frames > 0)
+    {
+        printf("Fragments of larger messages dropped without an assembler %" PRIu64 "\n", data.fragmented_frames);
+    }
+    printf("Polls: %s, %" PRIu64 " polls, %.1f%% empty, %.1f %s per poll with data",
+           poll_mode_names[poll_mode],
+           polls,
+           polls > 0 ? 100.0 * (double)empty_polls / (double)polls : 0.0,
+           polls > empty_polls ? (double)read_total / (double)(polls - empty_polls) : 0.0,
+           POLL_MODE_BLOCK == poll_mode ? "bytes" : "fragments");
+    if (adaptive_fragment_limit)
+        printf(", fragment limit adapted to %zu", poll_limit);
+    printf("\n");
+
+    message_dispatcher_print_report(&data.dispatcher);
+    printf(
+        "Decoded trade volume %" PRIu64 " notional %" PRIu64 ", quote spread sum %" PRIu64 " crossed %" PRIu64 "\n",
+        data.trade_volume,
+        data.trade_notional,
+        data.quote_spread_sum,
+        data.crossed_quotes);
+    sequence_tracker_print_report(&data.sequence_tracker);
+
+    if (data.top_of_book != NULL)
+    {
+        top_of_book_print_report(&top_of_book, duration_ns);
+    }
+
+    if (data.journal != NULL)
+    {
+        printf(
+            "Journal: %" PRIu64 " records, %.04g MB, %.04g MB/sec, %" PRIu64 " segment grows taking %.3f ms total, %.3f ms max\n",
+            journal.record_count,
+            (double)journal.position / (double)(1024 * 1024),
+            (double)journal.position * (double)(1000 * 1000 * 1000) / (double)duration_ns / (double)(1024 * 1024),
+            journal.grow_count,
+            (double)journal.grow_total_ns / (1000.0 * 1000.0),
+            (double)journal.grow_max_ns / (1000.0 * 1000.0));
+    }
+
+    if (record_latency)
+    {
+        histogram_add(&latency_histogram, &interval_latency_histogram);
+        print_latency_report("Total", &latency_histogram);
+        // the latency counters end with the whole run rather than the last interval
+        if (export_counters)
+            update_latency_counters(&counters, &latency_histogram);
+    }
+
+    if (print_json)
+    {
+        json_report_t report;
+        json_report_begin(&report, stdout, "sub");
+        json_report_string(&report, "channel", channel);
+        json_report_int(&report, "stream_id", stream_id);
+        json_report_string(&report, "poll_mode", poll_mode_names[poll_mode]);
+        json_report_uint(&report, "fragment_limit", fragment_limit);
+        if (adaptive_fragment_limit)
+            json_report_uint(&report, "fragment_limit_final", poll_limit);
+        if (POLL_MODE_BLOCK == poll_mode)
+            json_report_uint(&report, "block_length_limit", block_length_limit);
+        json_report_uint(&report, "polls", polls);
+        json_report_uint(&report, "empty_polls", empty_polls);
+        json_report_uint(&report, "fragmented_frames", data.fragmented_frames);
+        json_report_int(&report, "duration_ns", duration_ns);
+        json_report_uint(&report, "messages", data.messages);
+        json_report_uint(&report, "bytes", data.bytes);
+        json_report_double(&report, "msgs_per_sec", (double)data.messages * (double)(1000 * 1000 * 1000) / (double)duration_ns);
+        json_report_double(&report, "bytes_per_sec", (double)data.bytes * (double)(1000 * 1000 * 1000) / (double)duration_ns);
+        json_report_uint(&report, "lost", sequence_tracker_lost(&data.sequence_tracker));
+        json_report_uint(&report, "warm_up_messages", data.warm_up_messages);
+        if (steady_state_tolerance > 0.0)
+            json_report_int(&report, "steady_state_ns", steady_state.steady ? steady_state.steady_after_ns : -1);
+        json_report_uint(&report, "malformed_fragments", data.malformed_fragments);
+        json_report_string(&report, "idle", idle_strategy_spec);
+        json_report_string(&report, "instrumentation", BENCH_INSTRUMENTATION_NAME);
+        json_report_string(&report, "clock", data.clock.name);
+        json_report_int(&report, "clock_max_drift_ns", data.clock.max_drift_ns);
+        if (report_clock_read_cost)
+            json_report_double(&report, "clock_read_ns", clock_read_ns);
+        json_report_int(&report, "cpu_time_ns", cpu_time_ns);
+        json_report_double(&report, "cpu_cores", cpu_time_cores(cpu_time_ns, wall_ns));
+        json_report_int(&report, "process_cpu_time_ns", process_cpu_ns);
+        if (record_latency)
+            json_report_histogram(&report, "latency", &latency_histogram);
+        if (measure_perf)
+            json_report_perf_counters(&report, "perf", &perf_values, data.messages);
+        json_report_end(&report);
+    }
 
     status = EXIT_SUCCESS;
 
 cleanup:
+    bench_counters_close(&counters);
+    image_workers_release(&image_workers);
     aeron_subscription_close(data.subscription, NULL, NULL);
     aeron_close(aeron);
     aeron_context_close(context);
+    image_workers_close(&image_workers);
+    embedded_driver_close(&driver);
     aeron_fragment_assembler_delete(fragment_assembler);
+    histogram_close(&latency_histogram);
+    histogram_close(&interval_latency_histogram);
+    sequence_tracker_close(&data.sequence_tracker);
+    top_of_book_close(&top_of_book);
+    capture_writer_close(&journal);
+    idle_strategy_close(&idle_strategy);
+    perf_counters_close(&perf_counters);
 
     return status;
 }
 
 extern bool is_running(void);
+extern void record_message_latency(handler_data_t *data, XC_HITIME timestamp);
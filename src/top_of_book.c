@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include <inttypes.h>
+
+#include <aeronc.h>
+#include <aeron_alloc.h>
+
+#include "top_of_book.h"
+
+int top_of_book_init(top_of_book_t *book, uint64_t expected_contracts)
+{
+    uint64_t capacity = 1024;
+    while (capacity * 3 < expected_contracts * 4)
+        capacity <<= 1;
+
+    size_t offset = 0;
+    memset(book, 0, sizeof(top_of_book_t));
+    if (aeron_alloc_aligned(&book->allocation, &offset, sizeof(top_of_book_entry_t) * capacity, sizeof(top_of_book_entry_t)) < 0)
+    {
+        return -1;
+    }
+
+    book->entries = (top_of_book_entry_t *)((uint8_t *)book->allocation + offset);
+    book->capacity_mask = capacity - 1;
+
+    // touch every page now so the first pass over the contracts does not measure page faults
+    memset(book->entries, 0, sizeof(top_of_book_entry_t) * capacity);
+
+    return 0;
+}
+
+void top_of_book_close(top_of_book_t *book)
+{
+    aeron_free(book->allocation);
+    book->allocation = NULL;
+    book->entries = NULL;
+}
+
+size_t top_of_book_memory_footprint(const top_of_book_t *book)
+{
+    return sizeof(top_of_book_entry_t) * (book->capacity_mask + 1);
+}
+
+void top_of_book_reset_counts(top_of_book_t *book)
+{
+    book->updates = 0;
+    book->probes = 0;
+    book->max_probe_length = 0;
+    book->rejected_updates = 0;
+}
+
+void top_of_book_print_report(const top_of_book_t *book, int64_t duration_ns)
+{
+    printf(
+        "Top of book: %" PRIu64 " contracts in %" PRIu64 " slots (%.04g MB), %" PRIu64 " updates, %.04g updates/sec, "
+        "mean probes %.03g, max probes %" PRIu64 "\n",
+        book->contract_count,
+        book->capacity_mask + 1,
+        (double)top_of_book_memory_footprint(book) / (double)(1024 * 1024),
+        book->updates,
+        duration_ns > 0 ? (double)book->updates * (double)(1000 * 1000 * 1000) / (double)duration_ns : 0.0,
+        book->updates + book->rejected_updates > 0 ?
+            (double)book->probes / (double)(book->updates + book->rejected_updates) : 0.0,
+        book->max_probe_length);
+
+    if (book->rejected_updates > 0)
+    {
+        printf("Top of book full, rejected updates %" PRIu64 "\n", book->rejected_updates);
+    }
+}
+
+extern uint64_t top_of_book_hash(uint64_t symbol_expiration, uint32_t strike_price);
+extern void top_of_book_record_probes(top_of_book_t *book, uint64_t probes);
+extern top_of_book_entry_t *top_of_book_lookup(
+    top_of_book_t *book, const xuint8 *symbol, const xuint8 *expiration, uint32_t strike_price);
+extern void top_of_book_on_quote(top_of_book_t *book, const struct nms_opra_quote_t *quote);
+extern void top_of_book_on_trade(top_of_book_t *book, const struct nms_opra_trade_t *trade);
@@ -0,0 +1,146 @@
+#ifndef TOP_OF_BOOK_H
+#define TOP_OF_BOOK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "nms_messages.h"
+
+/* One cache line per contract, the key and both sides of the book are touched by a single miss. */
+typedef struct top_of_book_entry_stct
+{
+    uint64_t symbol_expiration;
+    uint32_t strike_price;
+    uint32_t bid_price;
+    uint32_t ask_price;
+    uint32_t bid_size;
+    uint32_t ask_size;
+    uint32_t last_trade_price;
+    uint32_t last_trade_volume;
+    uint32_t trade_count;
+    XC_HITIME quote_timestamp;
+    XC_HITIME trade_timestamp;
+    uint8_t bid_exchange;
+    uint8_t ask_exchange;
+    uint8_t last_trade_exchange;
+    uint8_t occupied;
+    uint8_t pad[4];
+} __attribute__((aligned(64))) top_of_book_entry_t;
+
+/*
+ * Open-addressing table keyed by symbol, expiration and strike with linear probing. The capacity is the
+ * power of two that keeps the load factor of the expected contract count at or below 3/4.
+ */
+typedef struct top_of_book_stct
+{
+    void *allocation;
+    top_of_book_entry_t *entries;
+    uint64_t capacity_mask;
+    uint64_t contract_count;
+    uint64_t updates;
+    uint64_t probes;
+    uint64_t max_probe_length;
+    uint64_t rejected_updates;
+} top_of_book_t;
+
+int top_of_book_init(top_of_book_t *book, uint64_t expected_contracts);
+void top_of_book_close(top_of_book_t *book);
+size_t top_of_book_memory_footprint(const top_of_book_t *book);
+/* Zeroes the update and probe counts, the book itself is kept. */
+void top_of_book_reset_counts(top_of_book_t *book);
+void top_of_book_print_report(const top_of_book_t *book, int64_t duration_ns);
+
+inline uint64_t top_of_book_hash(uint64_t symbol_expiration, uint32_t strike_price)
+{
+    uint64_t h = symbol_expiration ^ ((uint64_t)strike_price * UINT64_C(0x9E3779B97F4A7C15));
+
+    h ^= h >> 33;
+    h *= UINT64_C(0xFF51AFD7ED558CCD);
+    h ^= h >> 33;
+
+    return h;
+}
+
+inline void top_of_book_record_probes(top_of_book_t *book, uint64_t probes)
+{
+    book->probes += probes;
+    if (probes > book->max_probe_length)
+        book->max_probe_length = probes;
+}
+
+/* Finds or inserts the contract, NULL once the table is full. Hits, inserts and misses all count their probes. */
+inline top_of_book_entry_t *top_of_book_lookup(
+    top_of_book_t *book, const xuint8 *symbol, const xuint8 *expiration, uint32_t strike_price)
+{
+    uint64_t symbol_expiration = 0;
+    memcpy(&symbol_expiration, symbol, 5);
+    memcpy((uint8_t *)&symbol_expiration + 5, expiration, 3);
+
+    uint64_t index = top_of_book_hash(symbol_expiration, strike_price) & book->capacity_mask;
+    for (uint64_t probe = 1; probe <= book->capacity_mask + 1; probe++)
+    {
+        top_of_book_entry_t *entry = &book->entries[index];
+
+        if (!entry->occupied)
+        {
+            entry->occupied = 1;
+            entry->symbol_expiration = symbol_expiration;
+            entry->strike_price = strike_price;
+            book->contract_count++;
+            top_of_book_record_probes(book, probe);
+            return entry;
+        }
+
+        if (entry->symbol_expiration == symbol_expiration && entry->strike_price == strike_price)
+        {
+            top_of_book_record_probes(book, probe);
+            return entry;
+        }
+
+        index = (index + 1) & book->capacity_mask;
+    }
+
+    // a full table is swept end to end before the update is rejected
+    top_of_book_record_probes(book, book->capacity_mask + 1);
+    return NULL;
+}
+
+inline void top_of_book_on_quote(top_of_book_t *book, const struct nms_opra_quote_t *quote)
+{
+    top_of_book_entry_t *entry = top_of_book_lookup(book, quote->symbol, quote->expiration, quote->strike_price);
+    if (NULL == entry)
+    {
+        book->rejected_updates++;
+        return;
+    }
+
+    entry->bid_price = quote->bid_price;
+    entry->ask_price = quote->ask_price;
+    entry->bid_size = quote->bid_size;
+    entry->ask_size = quote->ask_size;
+    entry->bid_exchange = quote->bid_exchange;
+    entry->ask_exchange = quote->ask_exchange;
+    entry->quote_timestamp = quote->timestamp;
+    book->updates++;
+}
+
+inline void top_of_book_on_trade(top_of_book_t *book, const struct nms_opra_trade_t *trade)
+{
+    top_of_book_entry_t *entry = top_of_book_lookup(book, trade->symbol, trade->expiration, trade->strike_price);
+    if (NULL == entry)
+    {
+        book->rejected_updates++;
+        return;
+    }
+
+    entry->last_trade_price = trade->premium_price;
+    entry->last_trade_volume = trade->volume;
+    entry->last_trade_exchange = trade->exchange;
+    entry->trade_count++;
+    entry->trade_timestamp = trade->timestamp;
+    book->updates++;
+}
+
+#endif